@@ -0,0 +1,49 @@
+#ifndef BINARIZATION_HPP
+#define BINARIZATION_HPP
+
+#include <opencv2/core/mat.hpp>
+
+namespace image_processor
+{
+
+    // 二值化方式
+    enum class BinarizeMode
+    {
+        FIXED,   // 固定阈值
+        OTSU,    // 大津法：由整幅图像的亮度直方图自动选择阈值
+        ADAPTIVE // 自适应：与 (2 * radius + 1) 邻域的亮度均值比较
+    };
+
+    // 二值化：输出为单通道 8 位图像（0 或 255），可直接交给 Compression::imageToTriplets
+    // 支持 8U/16U/32F 深度和 1/3/4 通道，彩色图像先按 BT.601 权重求亮度，16 位和浮点图像的亮度换算为 8 位色阶；
+    // 亮度的换算与阈值比较在同一次按行带并行的遍历中完成，不生成中间灰度图像
+    // invert 为 true 时交换前景和背景：扫描文档中文字变为 255，三元组只需保存文字像素
+    // 与 ColorProcessing 相同，每个操作都有返回新图像和写入 dst 的两种形式，dst 可以与输入为同一图像
+    class Binarization
+    {
+    public:
+        // 固定阈值：亮度大于 threshold（8 位色阶，0-255）的像素为 255
+        static cv::Mat threshold(const cv::Mat &image, double threshold, bool invert = false);
+        static bool threshold(const cv::Mat &image, cv::Mat &dst, double threshold, bool invert = false);
+
+        // 大津法：先用一次遍历统计亮度直方图，取类间方差最大的阈值
+        static cv::Mat otsu(const cv::Mat &image, bool invert = false);
+        static bool otsu(const cv::Mat &image, cv::Mat &dst, bool invert = false);
+
+        // 只计算大津法阈值（8 位色阶），亮度大于该值的像素为前景
+        static bool otsuThreshold(const cv::Mat &image, int &threshold);
+
+        // 自适应阈值：亮度大于邻域均值减 offset（8 位色阶）的像素为 255
+        // 邻域和由可分离的滑动窗口和求得（先按行带求行方向的和，再按列块求列方向的和），亮度只换算一次，
+        // 每个像素的计算量与半径无关；邻域超出图像时只统计图像内的像素
+        static cv::Mat adaptive(const cv::Mat &image, int radius, double offset, bool invert = false);
+        static bool adaptive(const cv::Mat &image, cv::Mat &dst, int radius, double offset, bool invert = false);
+
+        // 按方式调用以上操作（FIXED 使用 threshold，ADAPTIVE 使用 radius 和 offset）
+        static bool binarize(const cv::Mat &image, cv::Mat &dst, BinarizeMode mode, double threshold, int radius,
+                             double offset, bool invert = false);
+    };
+
+} // namespace image_processor
+
+#endif // BINARIZATION_HPP
@@ -0,0 +1,54 @@
+#ifndef COLOR_KERNELS_HPP
+#define COLOR_KERNELS_HPP
+
+#include <opencv2/core/mat.hpp>
+#include "color_processing.hpp"
+#include "color_lut.hpp"
+
+namespace image_processor
+{
+
+    // 颜色操作的区域级实现：在调用方给定的图像区域上单线程执行，不输出日志
+    // ColorProcessing 在各行带上调用，ColorPipeline 在各条带上调用，两者结果因此完全一致
+    // 支持 8U/16U/32F 深度和 1/3/4 通道：BGRA 图像只处理颜色通道，Alpha 通道原样保留；
+    // dst 都可以与 src 为同一区域（BGR 图像灰度化会改变通道数，此时除外）
+    class ColorKernels
+    {
+    public:
+        // 是否支持该图像格式
+        static bool isSupported(const cv::Mat &image);
+
+        // 灰度化结果的图像类型：BGR 图像输出单通道，BGRA 图像输出三个颜色通道相同的 BGRA 图像
+        static int grayscaleType(const cv::Mat &src);
+
+        // 默认权重灰度化
+        static void grayscale(const cv::Mat &src, cv::Mat &dst);
+
+        // 自定义权重灰度化（权重需已归一化）
+        static void grayscaleCustom(const cv::Mat &src, cv::Mat &dst, double weight_r, double weight_g, double weight_b);
+
+        // 线性变换 alpha * x + beta（beta 以图像自身的取值范围为单位）
+        static void brightnessContrast(const cv::Mat &src, cv::Mat &dst, double alpha, double beta);
+
+        // 按颜色通道的线性变换 alpha[c] * x + beta[c]（单通道图像只使用第 0 项）
+        static void channelLinear(const cv::Mat &src, cv::Mat &dst, const cv::Vec3d &alpha, const cv::Vec3d &beta);
+
+        // 饱和度调整；HSV 方式只支持 8 位和浮点 BGR，其余格式按亮度插值处理
+        static void saturation(const cv::Mat &src, cv::Mat &dst, double factor, SaturationMode mode, cv::Mat &scratch);
+
+        // 反色
+        static void invert(const cv::Mat &src, cv::Mat &dst);
+
+        // sRGB 编码值转换为线性光：8 位图像输出 16 位，16 位和浮点图像保持深度（Alpha 只换算位深）
+        static void srgbToLinear(const cv::Mat &src, cv::Mat &dst);
+
+        // 线性光转换回 sRGB 编码，输出深度为 depth（16 位线性光可以直接输出 8 位）
+        static void linearToSrgb(const cv::Mat &src, cv::Mat &dst, int depth);
+
+        // 三维查找表四面体插值（只作用于 BGR/BGRA 图像的颜色通道）
+        static void lut3D(const cv::Mat &src, cv::Mat &dst, const ColorLut3D &lut);
+    };
+
+} // namespace image_processor
+
+#endif // COLOR_KERNELS_HPP
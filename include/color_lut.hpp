@@ -0,0 +1,55 @@
+#ifndef COLOR_LUT_HPP
+#define COLOR_LUT_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace image_processor
+{
+
+    // 三维颜色查找表（.cube 格式）
+    // 表项按 RGB 顺序存储，红色分量变化最快；解析结果按文本内容缓存（命中时比较完整文本），重复请求不再解析
+    class ColorLut3D
+    {
+    public:
+        // 解析 .cube 文本，内容相同时直接返回缓存的查找表；格式错误或格点数超过 65 时返回空指针
+        static std::shared_ptr<const ColorLut3D> fromCube(const std::string &text);
+
+        // 读取并解析 .cube 文件
+        static std::shared_ptr<const ColorLut3D> loadCube(const std::string &filepath);
+
+        // 缓存管理
+        static void clearCache();
+        static size_t cacheSize();
+
+        // 每个维度的格点数
+        int size() const;
+
+        const std::string &title() const;
+
+        // 输入值域（DOMAIN_MIN / DOMAIN_MAX，按 RGB 顺序）
+        const float *domainMin() const;
+        const float *domainMax() const;
+
+        // 格点 (r, g, b) 处的输出颜色（RGB 顺序的三个浮点数）
+        const float *entry(int r, int g, int b) const;
+
+        // 全部表项，size^3 * 3 个浮点数
+        const float *data() const;
+
+    private:
+        int size_ = 0;
+        std::string title_;
+        float domain_min_[3] = {0.f, 0.f, 0.f};
+        float domain_max_[3] = {1.f, 1.f, 1.f};
+        std::vector<float> table_;
+
+        // 辅助函数：解析 .cube 文本，不使用缓存
+        static std::shared_ptr<ColorLut3D> parse(const std::string &text);
+    };
+
+} // namespace image_processor
+
+#endif // COLOR_LUT_HPP
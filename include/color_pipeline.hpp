@@ -0,0 +1,185 @@
+#ifndef COLOR_PIPELINE_HPP
+#define COLOR_PIPELINE_HPP
+
+#include <opencv2/core/mat.hpp>
+#include "lookup_table.hpp"
+#include "color_processing.hpp"
+#include "color_lut.hpp"
+#include "binarization.hpp"
+#include "convolution.hpp"
+#include <memory>
+#include <vector>
+
+namespace image_processor
+{
+
+    // 颜色图层操作类型
+    enum class ColorOperationType
+    {
+        GRAYSCALE,
+        GRAYSCALE_CUSTOM,
+        BRIGHTNESS,
+        CONTRAST,
+        SATURATION,
+        INVERT,
+        EQUALIZE,
+        LUT3D,
+        CHANNEL_LINEAR,
+        AUTO_LEVELS,
+        AUTO_WHITE_BALANCE,
+        BLUR,
+        GAUSSIAN_BLUR,
+        UNSHARP_MASK,
+        SHARPEN,
+        GUIDED_FILTER,
+        DILATE,
+        ERODE,
+        OPEN,
+        CLOSE,
+        MEDIAN,
+        CONVOLVE,
+        BINARIZE
+    };
+
+    // 直方图均衡化方式
+    enum class EqualizeMode
+    {
+        GLOBAL,  // 整幅图像统一的直方图均衡化
+        ADAPTIVE // 分块的自适应直方图均衡化（CLAHE）
+    };
+
+    // 单个颜色图层及其参数（CHANNEL_LINEAR 的前三项为 B/G/R 的倍数，后三项为偏移）
+    struct ColorOperation
+    {
+        ColorOperationType type;
+        double params[6];
+        std::shared_ptr<const ColorLut3D> lut = nullptr; // 仅 LUT3D 图层使用
+        std::shared_ptr<const cv::Mat> kernel = nullptr; // 仅 CONVOLVE 图层使用（params[0] 为卷积方式）
+    };
+
+    // 颜色图层流水线：把整个图层栈合并为一次遍历
+    // 图像按行切分为能留在缓存中的条带，每个条带依次经过所有图层后只写回一次，
+    // 8 位图像中连续的亮度/对比度/反色图层被合并为一张查找表，16 位和浮点图像的各图层在缓存中的条带上依次执行，
+    // BGRA 图像的各图层只作用于颜色通道，Alpha 通道随条带原样传递；结果与逐层调用 ColorProcessing 完全一致
+    // 直方图均衡化、自动色阶和自动白平衡依赖整幅图像的统计量，作为屏障把图层栈切分为前后两段分别单次遍历；
+    // 自动色阶和自动白平衡只做一次统计遍历，求出的逐通道线性变换并入后一段的遍历中执行；
+    // 模糊、锐化、形态学、自定义卷积和二值化依赖邻域像素或整幅图像，同样作为屏障整图执行
+    // 线性光模式下 sRGB 解码和编码分别在每个条带的第一个和最后一个阶段完成，不增加额外的整幅图像遍历
+    class ColorPipeline
+    {
+    public:
+        // 添加图层（按从上到下的顺序）
+        void addGrayscale();
+        void addGrayscale(double weight_r, double weight_g, double weight_b);
+        void addBrightness(int brightness);
+        void addContrast(int contrast);
+        void addSaturation(int saturation, SaturationMode mode = SaturationMode::LUMA);
+        void addInvert();
+        void addEqualize(EqualizeMode mode = EqualizeMode::GLOBAL, double clip_limit = 2.0, int tile_grid = 8);
+        void addLut3D(std::shared_ptr<const ColorLut3D> lut);
+        void addChannelLinear(const cv::Vec3d &alpha, const cv::Vec3d &beta);
+        // sample_step 为统计时的抽样间隔（0 表示按图像尺寸自动选择）
+        void addAutoLevels(double clip_percent = 0.5, int sample_step = 1);
+        void addAutoWhiteBalance(int sample_step = 1);
+        void addBlur(int radius);
+        void addGaussianBlur(double sigma);
+        void addUnsharpMask(double radius, double amount, double threshold = 0.0);
+        void addSharpen(double amount);
+        void addGuidedFilter(int radius, double eps);
+        void addDilate(int radius);
+        void addErode(int radius);
+        void addOpen(int radius);
+        void addClose(int radius);
+        void addMedian(int radius);
+        void addConvolution(const cv::Mat &kernel, ConvolutionMethod method = ConvolutionMethod::AUTO);
+        // 二值化后图像变为单通道 8 位图像，后续图层在二值图像上执行
+        void addBinarize(BinarizeMode mode, double threshold, int radius, double offset, bool invert = false);
+
+        // 线性光模式：各图层在线性光下执行（8 位图像在条带内以 16 位线性值处理），
+        // 三维查找表、直方图均衡化和空间滤波仍作用于 sRGB 编码值
+        void setLinearLight(bool enabled);
+        bool linearLight() const;
+
+        bool empty() const;
+        size_t size() const;
+        const std::vector<ColorOperation> &operations() const;
+
+        // 取出 [begin, end) 范围内的图层组成新的流水线（保留线性光设置）
+        ColorPipeline slice(size_t begin, size_t end) const;
+
+        // 对图像执行全部图层
+        cv::Mat apply(const cv::Mat &image) const;
+
+        // 对图像执行全部图层，结果写入 result（可与 image 为同一图像），成功返回 true
+        bool apply(const cv::Mat &image, cv::Mat &result) const;
+
+        // 在当前线程对图像的一部分执行全部图层，不输出日志；供已自行分块并行的调用方使用
+        // 仅适用于 isPointwise() 为 true 的流水线
+        bool applyRegion(const cv::Mat &region, cv::Mat &result) const;
+
+        // 输入为 input_channels 通道时输出图像的通道数（图层参数无效时返回 -1）
+        int outputChannels(int input_channels) const;
+
+        // 所有图层是否都只依赖单个像素（可以对图像任意分块后独立处理）
+        bool isPointwise() const;
+
+        // 最后一个依赖整幅图像或邻域像素的图层之后的位置（没有这样的图层时为 0），其后的图层都是逐像素操作
+        size_t pointwiseTail() const;
+
+    private:
+        // 线性光模式下插入的传递函数阶段
+        enum class Transfer
+        {
+            NONE,
+            TO_LINEAR,
+            TO_SRGB
+        };
+
+        // 编译后的执行阶段：连续的点运算合并为一张查找表
+        struct Stage
+        {
+            ColorOperation operation;
+            bool use_table;
+            LookupTable table;
+            Transfer transfer = Transfer::NONE;
+            int transfer_depth = -1; // TO_SRGB 阶段的输出深度
+        };
+
+        std::vector<ColorOperation> operations_;
+        bool linear_light_ = false;
+
+        // 辅助函数：执行全部图层；region 为 true 时在当前线程完成且不输出日志
+        bool run(const cv::Mat &image, cv::Mat &result, bool region) const;
+
+        // 辅助函数：在屏障图层处切分图层栈，各段分别单次遍历
+        bool applySegments(const cv::Mat &image, cv::Mat &result) const;
+
+        // 辅助函数：执行单个均衡化图层
+        static bool applyEqualize(const ColorOperation &operation, const cv::Mat &image, cv::Mat &result);
+
+        // 辅助函数：由统计量把自动色阶/自动白平衡图层换算为逐通道线性变换图层
+        static bool resolveAutoOperation(const ColorOperation &operation, const cv::Mat &image, ColorOperation &resolved);
+
+        // 辅助函数：执行单个空间滤波图层
+        static bool applySpatial(const ColorOperation &operation, const cv::Mat &image, cv::Mat &result);
+
+        // 辅助函数：该图层是否依赖整幅图像的统计量或邻域像素
+        static bool isBarrier(ColorOperationType type);
+
+        // 辅助函数：该图层是否为空间滤波
+        static bool isSpatial(ColorOperationType type);
+
+        // 辅助函数：不支持条带融合时逐层调用 ColorProcessing
+        bool applySequential(const cv::Mat &image, cv::Mat &result) const;
+
+        // 辅助函数：按输入格式筛选出实际生效的图层，合并 8 位点运算，并推算输出通道数
+        bool compileStages(int depth, int input_channels, std::vector<Stage> &stages, int &output_channels,
+                           bool report_skipped) const;
+
+        // 辅助函数：在单个条带上执行一个阶段
+        static void applyStage(const Stage &stage, const cv::Mat &src, cv::Mat &dst, cv::Mat &scratch);
+    };
+
+} // namespace image_processor
+
+#endif // COLOR_PIPELINE_HPP
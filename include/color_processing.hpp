@@ -2,39 +2,92 @@
 #define COLOR_PROCESSING_HPP
 
 #include <opencv2/core/mat.hpp>
+#include "color_lut.hpp"
 
 namespace image_processor
 {
 
+    // 饱和度调整方式
+    enum class SaturationMode
+    {
+        LUMA, // 在 BGR 空间中向亮度插值（默认，单次遍历）
+        HSV   // 转换到 HSV 空间调整 S 通道（与旧版本输出逐位一致）
+    };
+
     class ColorProcessing
     {
     public:
+        // 以下每个操作都有两种形式：
+        // 返回新图像的版本，以及把结果写入调用方提供的 dst 的版本（成功返回 true）
+        // dst 的尺寸和类型匹配时直接复用其内存；dst 可以与输入为同一图像（原地处理），
+        // 其中灰度化和伪彩色会改变通道数，原地调用时会为 dst 重新分配内存
+        // BGRA 图像只处理颜色通道，Alpha 通道原样保留（灰度化输出三个颜色通道相同的 BGRA 图像）
+
         // 将彩色图像转换为灰度图像
         static cv::Mat convertToGrayscale(const cv::Mat &color_image);
+        static bool convertToGrayscale(const cv::Mat &color_image, cv::Mat &dst);
 
         // 将彩色图像转换为灰度图像（自定义权重）
         static cv::Mat convertToGrayscale(const cv::Mat &color_image, double weight_r, double weight_g, double weight_b);
+        static bool convertToGrayscale(const cv::Mat &color_image, cv::Mat &dst, double weight_r, double weight_g, double weight_b);
 
         // 将灰度图像转换为彩色图像（伪彩色）
         static cv::Mat convertToColor(const cv::Mat &grayscale_image);
+        static bool convertToColor(const cv::Mat &grayscale_image, cv::Mat &dst);
 
         // 调整图像亮度和对比度
         static cv::Mat adjustBrightnessContrast(const cv::Mat &image, double alpha, double beta);
+        static bool adjustBrightnessContrast(const cv::Mat &image, cv::Mat &dst, double alpha, double beta);
 
         // 调整图像亮度
         static cv::Mat adjustBrightness(const cv::Mat &image, int brightness);
+        static bool adjustBrightness(const cv::Mat &image, cv::Mat &dst, int brightness);
 
         // 调整图像对比度
         static cv::Mat adjustContrast(const cv::Mat &image, int contrast);
+        static bool adjustContrast(const cv::Mat &image, cv::Mat &dst, int contrast);
 
         // 调整图像饱和度
-        static cv::Mat adjustSaturation(const cv::Mat &image, int saturation);
+        static cv::Mat adjustSaturation(const cv::Mat &image, int saturation,
+                                        SaturationMode mode = SaturationMode::LUMA);
+        static bool adjustSaturation(const cv::Mat &image, cv::Mat &dst, int saturation,
+                                     SaturationMode mode = SaturationMode::LUMA);
 
-        // 图像直方图均衡化
+        // 图像直方图均衡化（彩色图像只均衡亮度通道，直方图由各线程分段统计后合并）
         static cv::Mat equalizeHistogram(const cv::Mat &image);
+        static bool equalizeHistogram(const cv::Mat &image, cv::Mat &dst);
+
+        // 自适应直方图均衡化（CLAHE）：图像划分为 tile_grid x tile_grid 个分块，各分块并行统计并限制对比度
+        // tile_grid 为 1 到 MAX_TILE_GRID
+        static const int MAX_TILE_GRID = 64;
+        static cv::Mat adaptiveEqualizeHistogram(const cv::Mat &image, double clip_limit = 2.0, int tile_grid = 8);
+        static bool adaptiveEqualizeHistogram(const cv::Mat &image, cv::Mat &dst, double clip_limit = 2.0, int tile_grid = 8);
 
         // 反色处理
         static cv::Mat invertColors(const cv::Mat &image);
+        static bool invertColors(const cv::Mat &image, cv::Mat &dst);
+
+        // 按颜色通道的线性变换 alpha[c] * x + beta[c]（beta 以图像自身的取值范围为单位，8 位图像使用查找表）
+        static cv::Mat adjustChannels(const cv::Mat &image, const cv::Vec3d &alpha, const cv::Vec3d &beta);
+        static bool adjustChannels(const cv::Mat &image, cv::Mat &dst, const cv::Vec3d &alpha, const cv::Vec3d &beta);
+
+        // 自动色阶：各颜色通道两端各裁剪 clip_percent% 的像素后拉伸到满量程
+        // sample_step 大于 1 时按间隔抽样估计统计量，为 0 时按图像尺寸自动选择间隔
+        static cv::Mat autoLevels(const cv::Mat &image, double clip_percent = 0.5, int sample_step = 1);
+        static bool autoLevels(const cv::Mat &image, cv::Mat &dst, double clip_percent = 0.5, int sample_step = 1);
+
+        // 自动白平衡（灰度世界假设）：按各颜色通道均值计算增益，使三个通道的均值相同
+        static cv::Mat autoWhiteBalance(const cv::Mat &image, int sample_step = 1);
+        static bool autoWhiteBalance(const cv::Mat &image, cv::Mat &dst, int sample_step = 1);
+
+        // 只做一次统计遍历，求出自动色阶/自动白平衡对应的逐通道线性变换（供流水线与后续图层合并执行）
+        static bool computeAutoLevels(const cv::Mat &image, double clip_percent, int sample_step,
+                                      cv::Vec3d &alpha, cv::Vec3d &beta);
+        static bool computeWhiteBalance(const cv::Mat &image, int sample_step, cv::Vec3d &alpha, cv::Vec3d &beta);
+
+        // 三维查找表调色（.cube，四面体插值）
+        static cv::Mat applyLut3D(const cv::Mat &image, const ColorLut3D &lut);
+        static bool applyLut3D(const cv::Mat &image, cv::Mat &dst, const ColorLut3D &lut);
     };
 
 } // namespace image_processor
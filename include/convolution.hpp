@@ -0,0 +1,43 @@
+#ifndef CONVOLUTION_HPP
+#define CONVOLUTION_HPP
+
+#include <opencv2/core/mat.hpp>
+#include <cstddef>
+
+namespace image_processor
+{
+
+    // 卷积方式
+    enum class ConvolutionMethod
+    {
+        AUTO,      // 按卷积核的大小和秩自动选择
+        DIRECT,    // 直接卷积（cv::filter2D）
+        SEPARABLE, // 秩为 1 的卷积核分解为列向量和行向量，先后做两次一维卷积
+        FFT        // 分块频域卷积（overlap-save），计算量与卷积核大小基本无关
+    };
+
+    // 自定义卷积核滤波
+    // 与 cv::filter2D 相同按相关运算计算（卷积核不翻转），锚点在卷积核中心，图像边界外按最近的边缘像素处理；
+    // 支持 8U/16U/32F 深度和 1/3/4 通道，各通道（包括 Alpha 通道）分别滤波，dst 可以与输入为同一图像
+    // 频域卷积把图像切分为固定尺寸的分块并行处理，卷积核的频谱按卷积核内容和分块尺寸缓存，重复请求不再计算
+    class Convolution
+    {
+    public:
+        // kernel 为单通道 CV_32F 或 CV_64F 矩阵，边长不超过 MAX_KERNEL_SIZE
+        static cv::Mat filter(const cv::Mat &image, const cv::Mat &kernel, ConvolutionMethod method = ConvolutionMethod::AUTO);
+        static bool filter(const cv::Mat &image, cv::Mat &dst, const cv::Mat &kernel,
+                           ConvolutionMethod method = ConvolutionMethod::AUTO);
+
+        // 自动选择时使用的方式：秩为 1 时分离，面积较小时直接卷积，否则频域卷积
+        static ConvolutionMethod selectMethod(const cv::Mat &kernel);
+
+        // 卷积核频谱缓存管理
+        static void clearCache();
+        static size_t cacheSize();
+
+        static const int MAX_KERNEL_SIZE = 255;
+    };
+
+} // namespace image_processor
+
+#endif // CONVOLUTION_HPP
@@ -13,7 +13,9 @@ namespace image_processor
         LINEAR,
         CUBIC,
         AREA,
-        LANCZOS
+        LANCZOS,
+        RESAMPLE_CUBIC,   // 内置可分离重采样器：三次卷积，抽头表按尺寸缓存
+        RESAMPLE_LANCZOS3 // 内置可分离重采样器：Lanczos3，抽头表按尺寸缓存
     };
 
     class ImageScaling
@@ -23,19 +25,43 @@ namespace image_processor
         static cv::Mat scaleImage(const cv::Mat &image, int new_width, int new_height,
                                   const std::string &method = "default");
 
+        // 按指定尺寸缩放图像，结果写入调用方提供的 dst（尺寸和类型匹配时复用其内存）
+        static void scaleImage(const cv::Mat &image, cv::Mat &dst, int new_width, int new_height,
+                               const std::string &method = "default");
+
         // 按指定比例缩放图像（使用字符串指定插值算法）
         static cv::Mat scaleImageByFactor(const cv::Mat &image, double scale_factor,
                                           const std::string &method = "default");
 
+        // 按指定比例缩放图像，结果写入调用方提供的 dst
+        static void scaleImageByFactor(const cv::Mat &image, cv::Mat &dst, double scale_factor,
+                                       const std::string &method = "default");
+
         // 图像放大（使用字符串指定插值算法）
         static cv::Mat enlargeImage(const cv::Mat &image, int new_width, int new_height,
                                     const std::string &method = "cubic");
 
         // 图像缩小（使用字符串指定插值算法）
+        // 区域插值和内置重采样器缩小 4 倍以上时，先用 2 倍方框金字塔缩小到目标尺寸的 2-4 倍，再做最终重采样
         static cv::Mat shrinkImage(const cv::Mat &image, int new_width, int new_height,
                                    const std::string &method = "area");
 
+        // 按缩放要求解析出实际使用的 OpenCV 插值标志（与 scaleImage 的选择规则一致）
+        // 使用内置重采样器（RESAMPLE_*）时返回 -1
+        static int interpolationFor(const cv::Size &image_size, int new_width, int new_height,
+                                    const std::string &method = "default");
+
+        // 整数倍快速路径（像素复制、方框平均）支持的最大倍数
+        static const int MAX_INTEGER_FACTOR = 4;
+
     private:
+        // 辅助函数：按缩放要求解析出实际使用的插值方法
+        static InterpolationMethod resolveInterpolationMethod(const cv::Size &image_size, int new_width, int new_height,
+                                                              const std::string &method);
+
+        // 辅助函数：判断是否可以走整数倍快速路径（8 位 1/3/4 通道，近邻放大或区域缩小）
+        static int integerFactor(const cv::Mat &image, const cv::Size &size, InterpolationMethod method);
+
         // 辅助函数：将字符串转换为插值方法枚举
         static InterpolationMethod stringToInterpolationMethod(const std::string &method_str);
 
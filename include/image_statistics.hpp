@@ -0,0 +1,54 @@
+#ifndef IMAGE_STATISTICS_HPP
+#define IMAGE_STATISTICS_HPP
+
+#include <opencv2/core/mat.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace image_processor
+{
+
+    // 单个通道的统计量（数值均以图像自身的取值范围为单位）
+    struct ChannelStats
+    {
+        std::vector<uint64_t> histogram; // HISTOGRAM_BINS 个分箱，等分 [0, 满量程]
+        double mean = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+        std::vector<double> percentiles; // 与 ImageStats::percentile_levels 一一对应
+    };
+
+    // 整幅图像的统计结果
+    struct ImageStats
+    {
+        int width = 0;
+        int height = 0;
+        int depth = CV_8U;
+        double max_value = 255.0;
+        int sample_step = 1;  // 抽样间隔（行和列）
+        uint64_t samples = 0; // 参与统计的像素数
+        std::vector<double> percentile_levels;
+        std::vector<ChannelStats> channels; // 按图像通道顺序（B、G、R、A）
+    };
+
+    // 图像统计：直方图、均值、最值和百分位数在一次按行带并行的遍历中完成，
+    // 各行带先统计局部结果，最后合并
+    class ImageStatistics
+    {
+    public:
+        // 输出直方图的分箱数
+        static const int HISTOGRAM_BINS = 256;
+
+        // 计算统计量，支持 8U/16U/32F 深度和 1/3/4 通道；percentile_levels 取值为 [0, 100]
+        // sample_step 大于 1 时只统计每隔 sample_step 行、sample_step 列的像素，用于快速估计超大图像的统计量
+        static bool compute(const cv::Mat &image, ImageStats &stats,
+                            const std::vector<double> &percentile_levels = {1, 5, 25, 50, 75, 95, 99},
+                            int sample_step = 1);
+
+        // 按图像尺寸选择抽样间隔，使抽样像素数不超过约 100 万
+        static int autoSampleStep(const cv::Mat &image);
+    };
+
+} // namespace image_processor
+
+#endif // IMAGE_STATISTICS_HPP
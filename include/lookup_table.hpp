@@ -0,0 +1,52 @@
+#ifndef LOOKUP_TABLE_HPP
+#define LOOKUP_TABLE_HPP
+
+#include <opencv2/core/mat.hpp>
+
+namespace image_processor
+{
+
+    // 8 位点运算查找表：每个通道一张 256 项的表
+    // 任意多个亮度/对比度/反色操作都可以合并为一张表，再用一次查表遍历完成
+    class LookupTable
+    {
+    public:
+        // 创建指定通道数的恒等表，通道数不在 1-4 之间时输出错误日志，得到空表
+        explicit LookupTable(int channels = 1);
+
+        // 拷贝时复制表数据，避免多个查找表共享同一块内存
+        LookupTable(const LookupTable &other);
+        LookupTable &operator=(const LookupTable &other);
+
+        // 追加点运算（channel 为 -1 时作用于所有通道），通道超出范围时返回 false
+        bool addBrightness(int brightness, int channel = -1);
+        bool addContrast(int contrast, int channel = -1);
+        bool addBrightnessContrast(double alpha, double beta, int channel = -1);
+        bool addInvert(int channel = -1);
+
+        // 追加另一张表：结果等价于先查本表再查 next，通道数不匹配时返回 false
+        bool compose(const LookupTable &next);
+
+        bool empty() const;
+
+        int channels() const;
+        uchar value(int channel, int input) const;
+        void setValue(int channel, int input, uchar output);
+
+        // 表数据：1x256 的 CV_8UC(channels) 矩阵，可直接用于 cv::LUT
+        const cv::Mat &table() const;
+
+        // 将查找表应用于 8 位图像
+        cv::Mat apply(const cv::Mat &image) const;
+        void apply(const cv::Mat &src, cv::Mat &dst) const;
+
+    private:
+        cv::Mat table_;
+
+        // 辅助函数：取出指定通道（或全部通道）的表项视图，通道超出范围时返回空矩阵
+        cv::Mat channelView(int channel);
+    };
+
+} // namespace image_processor
+
+#endif // LOOKUP_TABLE_HPP
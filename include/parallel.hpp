@@ -0,0 +1,38 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <opencv2/core/mat.hpp>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+namespace image_processor
+{
+
+    // 行带并行：把图像按行切分为若干行带，交给 OpenCV 的共享线程池执行
+    // 像素数低于阈值的小图像直接在当前线程执行，避免调度开销
+    class Parallel
+    {
+    public:
+        // 设置工作线程数（小于等于 0 表示使用全部 CPU 核心）
+        static void setThreadCount(int threads);
+        static int threadCount();
+
+        // 设置触发并行的最小像素数
+        static void setMinParallelPixels(size_t pixels);
+        static size_t minParallelPixels();
+
+        // 对图像的所有行按行带执行 body，每次调用传入一个行范围
+        static void forEachRowBand(const cv::Mat &image, const std::function<void(const cv::Range &)> &body);
+        static void forEachRowBand(int rows, int cols, const std::function<void(const cv::Range &)> &body);
+
+        // 按列切分图像，每次调用传入一个列范围（用于沿列方向递推的滤波，各列块从上到下独立扫描）
+        static void forEachColumnBand(const cv::Mat &image, const std::function<void(const cv::Range &)> &body);
+
+    private:
+        static std::atomic<size_t> min_parallel_pixels_;
+    };
+
+} // namespace image_processor
+
+#endif // PARALLEL_HPP
@@ -0,0 +1,42 @@
+#ifndef PIPELINE_PLANNER_HPP
+#define PIPELINE_PLANNER_HPP
+
+#include <opencv2/core/mat.hpp>
+#include "color_pipeline.hpp"
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+namespace image_processor
+{
+
+    // 处理链规划器：缩小图像时把缩放提前到末尾的逐像素颜色图层之前，这些图层只需处理缩小后的像素
+    // 只移动最后一个屏障图层（均衡化、自动色阶/白平衡、空间滤波、二值化）之后的图层，屏障图层与缩放的先后顺序不变；
+    // 调整顺序带来的差异（截断、舍入、非线性图层）在覆盖整幅图像（包括边缘）的 3x3 网格样本上实测，
+    // 误差最大的样本的平均绝对误差不超过容差时才采用
+    class PipelinePlanner
+    {
+    public:
+        // 返回在缩放之前执行的图层数：等于图层总数表示保持原顺序（先执行全部图层再缩放）
+        // tolerance 为允许的平均绝对误差（8 位色阶），小于等于 0 时总是保持原顺序
+        static size_t scaleSplit(const cv::Mat &image, const ColorPipeline &pipeline, int new_width, int new_height,
+                                 const std::string &method, double tolerance);
+
+        // 按计划执行：[0, split) 图层在原尺寸执行，随后缩放，其余图层在缩放后的尺寸执行，结果写入 dst
+        static bool run(const cv::Mat &image, cv::Mat &dst, const ColorPipeline &pipeline, size_t split,
+                        int new_width, int new_height, const std::string &method);
+
+        // 设置默认容差（8 位色阶），请求未指定容差时使用
+        static void setTolerance(double tolerance);
+        static double tolerance();
+
+    private:
+        static std::atomic<double> tolerance_;
+
+        // 辅助函数：两个结果的平均绝对误差（取各通道的最大值，换算为 8 位色阶）
+        static double meanError(const cv::Mat &a, const cv::Mat &b);
+    };
+
+} // namespace image_processor
+
+#endif // PIPELINE_PLANNER_HPP
@@ -0,0 +1,124 @@
+#ifndef PIXEL_KERNELS_HPP
+#define PIXEL_KERNELS_HPP
+
+#include <opencv2/core.hpp>
+#include "parallel.hpp"
+
+namespace image_processor
+{
+
+    // 各像素深度的满量程值（浮点图像约定取值范围为 [0, 1]）
+    template <typename T>
+    struct PixelTraits;
+
+    template <>
+    struct PixelTraits<uchar>
+    {
+        static constexpr double max_value = 255.0;
+    };
+
+    template <>
+    struct PixelTraits<ushort>
+    {
+        static constexpr double max_value = 65535.0;
+    };
+
+    template <>
+    struct PixelTraits<float>
+    {
+        static constexpr double max_value = 1.0;
+    };
+
+    // 像素格式标签：元素类型和通道数都是编译期常量
+    template <typename T, int Cn>
+    struct PixelFormat
+    {
+        typedef T value_type;
+        static constexpr int channels = Cn;
+    };
+
+    // 模板化逐像素内核框架
+    // 每次调用只在开始时按深度和通道数选择一次模板实例，内层循环中通道数是编译期常量，
+    // 编译器可以完全展开每个像素的计算并自动向量化；各行带交给共享线程池并行执行
+    class PixelKernels
+    {
+    public:
+        // 按深度（8U/16U/32F）和通道数（1/3/4）调用 body(PixelFormat<T, Cn>())，不支持的格式返回 false
+        template <typename Body>
+        static bool dispatch(int depth, int channels, Body &&body)
+        {
+            switch (depth)
+            {
+            case CV_8U:
+                return dispatchChannels<uchar>(channels, body);
+            case CV_16U:
+                return dispatchChannels<ushort>(channels, body);
+            case CV_32F:
+                return dispatchChannels<float>(channels, body);
+            default:
+                return false;
+            }
+        }
+
+        // 元素类型已确定时只按通道数选择模板实例
+        template <typename T, typename Body>
+        static bool dispatchChannels(int channels, Body &&body)
+        {
+            switch (channels)
+            {
+            case 1:
+                body(PixelFormat<T, 1>());
+                return true;
+            case 3:
+                body(PixelFormat<T, 3>());
+                return true;
+            case 4:
+                body(PixelFormat<T, 4>());
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        // 对每个像素调用 functor(const T *src_pixel, T *dst_pixel)，按行带并行
+        // dst 需预先分配为相同尺寸；dst 可以与 src 为同一图像，此时 functor 必须先读取源通道再写入对应的目标通道
+        template <typename T, int SrcCn, int DstCn, typename Functor>
+        static void transform(const cv::Mat &src, cv::Mat &dst, Functor functor)
+        {
+            Parallel::forEachRowBand(src, [&](const cv::Range &rows)
+                                     { transformRows<T, SrcCn, DstCn>(src, dst, rows, functor); });
+        }
+
+        // 只处理指定行范围，供已经按行带并行的调用方在带内使用
+        template <typename T, int SrcCn, int DstCn, typename Functor>
+        static void transformRows(const cv::Mat &src, cv::Mat &dst, const cv::Range &rows, Functor &functor)
+        {
+            for (int i = rows.start; i < rows.end; ++i)
+            {
+                const T *src_row = src.ptr<T>(i);
+                T *dst_row = dst.ptr<T>(i);
+                for (int j = 0; j < src.cols; ++j)
+                {
+                    functor(src_row + j * SrcCn, dst_row + j * DstCn);
+                }
+            }
+        }
+
+        // 深度对应的满量程值，不支持的深度按 8 位处理
+        static double maxValue(int depth)
+        {
+            switch (depth)
+            {
+            case CV_16U:
+                return PixelTraits<ushort>::max_value;
+            case CV_32F:
+                return PixelTraits<float>::max_value;
+            default:
+                return PixelTraits<uchar>::max_value;
+            }
+        }
+    };
+
+} // namespace image_processor
+
+#endif // PIXEL_KERNELS_HPP
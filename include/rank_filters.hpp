@@ -0,0 +1,37 @@
+#ifndef RANK_FILTERS_HPP
+#define RANK_FILTERS_HPP
+
+#include <opencv2/core/mat.hpp>
+
+namespace image_processor
+{
+
+    // 排序统计滤波：形态学（膨胀/腐蚀/开/闭运算）和中值滤波
+    // 窗口为 (2 * radius + 1) 的正方形，图像边界外按最近的边缘像素处理，每个像素的计算量与半径无关；
+    // 各通道（包括 BGRA 的 Alpha 通道）分别滤波
+    // 与 ColorProcessing 相同，每个操作都有返回新图像和写入 dst 的两种形式，dst 可以与输入为同一图像
+    class RankFilters
+    {
+    public:
+        // 膨胀（窗口最大值）和腐蚀（窗口最小值），支持 8U/16U/32F 深度和 1/3/4 通道
+        // 使用 van Herk / Gil-Werman 算法，先按行、再按列各求一次一维窗口极值
+        static cv::Mat dilate(const cv::Mat &image, int radius);
+        static bool dilate(const cv::Mat &image, cv::Mat &dst, int radius);
+        static cv::Mat erode(const cv::Mat &image, int radius);
+        static bool erode(const cv::Mat &image, cv::Mat &dst, int radius);
+
+        // 开运算（先腐蚀后膨胀，去除小亮点）和闭运算（先膨胀后腐蚀，填补小暗点）
+        static cv::Mat open(const cv::Mat &image, int radius);
+        static bool open(const cv::Mat &image, cv::Mat &dst, int radius);
+        static cv::Mat close(const cv::Mat &image, int radius);
+        static bool close(const cv::Mat &image, cv::Mat &dst, int radius);
+
+        // 中值滤波：半径 1 和 2 使用 cv::medianBlur；更大的半径使用基于直方图的恒定时间算法（Perreault & Hébert），
+        // 8 位图像结果精确，16 位和浮点图像的直方图量化到 12 位，输出中值所在分箱的中心值
+        static cv::Mat median(const cv::Mat &image, int radius);
+        static bool median(const cv::Mat &image, cv::Mat &dst, int radius);
+    };
+
+} // namespace image_processor
+
+#endif // RANK_FILTERS_HPP
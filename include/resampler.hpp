@@ -0,0 +1,72 @@
+#ifndef RESAMPLER_HPP
+#define RESAMPLER_HPP
+
+#include <opencv2/core/mat.hpp>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace image_processor
+{
+
+    // 重采样滤波器
+    enum class ResampleFilter
+    {
+        CUBIC,   // Keys 三次卷积（a = -0.5），支撑半径 2
+        LANCZOS3 // Lanczos（a = 3），支撑半径 3
+    };
+
+    // 一个方向上的抽头表：输出第 i 个像素 = sum(weights[i * taps + k] * 输入[starts[i] + k])，k < taps
+    // 缩小时滤波器按缩小倍数展宽（抽头数随之增加），保证大倍数缩小仍然抗混叠
+    // 超出输入范围的权重已合并到边缘像素（等价于边缘复制），所有窗口都落在 [0, 输入尺寸) 内
+    // fixed_weights 为同一组权重的 Q14 定点数（每个输出像素的权重和恰好为 1 << 14），供 8 位 SIMD 内核使用
+    struct ResampleTaps
+    {
+        int taps = 0;
+        std::vector<int> starts;
+        std::vector<float> weights;
+        std::vector<short> fixed_weights;
+    };
+
+    // 可分离重采样：按输出行切分为缓存大小的条带，每个条带先把所需输入行水平重采样到条带缓冲区，再垂直重采样输出，
+    // 水平结果在留在缓存中时就被使用；相邻条带重叠的输入行直接复用，不重复计算
+    // 8 位图像使用 16 位定点权重和 AVX2/SSE2 行内核（中间结果为带 6 位小数的 16 位整数），16 位和浮点图像使用浮点权重
+    // 行、列两个方向的抽头表按（输入尺寸、输出尺寸、滤波器）缓存，各线程共享，重复的缩放尺寸不再计算权重
+    // 支持 8U/16U/32F 深度和 1/3/4 通道，各通道（包括 Alpha 通道）分别重采样
+    class Resampler
+    {
+    public:
+        // 缩放到 size，dst 可以与 src 为同一图像
+        static bool resize(const cv::Mat &src, cv::Mat &dst, const cv::Size &size, ResampleFilter filter);
+
+        // 2x2 方框缩小：输出尺寸为输入的一半（向上取整，奇数尺寸的最后一行/列按边缘复制参与平均），dst 不能与 src 为同一图像
+        // 8 位图像使用 SSE2 行内核，按行带并行
+        static bool halve(const cv::Mat &src, cv::Mat &dst);
+
+        // 金字塔缩小：反复做 2x2 方框缩小，直到再缩小一次两个方向都会不足目标尺寸的 2 倍，返回最后一层；
+        // 缩小倍数不足 4 倍时不建立金字塔，直接返回 src。之后只需从这一层做一次高质量重采样，
+        // 总读取量接近读一遍原图（各层依次为 1/4、1/16 ……）
+        static cv::Mat pyramidLevel(const cv::Mat &src, const cv::Size &size);
+
+        // 从 src_size 缩放到 size 时 pyramidLevel 是否会建立金字塔（至少缩小一层）
+        static bool buildsPyramid(const cv::Size &src_size, const cv::Size &size);
+
+        // 整数倍近邻放大：每个像素复制为 factor x factor 的块，每个输出行由一次字节重排复制生成，其余行直接拷贝
+        // 只支持 8 位 1/3/4 通道图像，dst 可以与 src 为同一图像
+        static bool replicate(const cv::Mat &src, cv::Mat &dst, int factor);
+
+        // 整数倍方框缩小：输出像素为对应 factor x factor 块的均值（与区域插值在整数倍时的结果一致），
+        // 输入尺寸必须是 factor 的整数倍；只支持 8 位 1/3/4 通道图像，factor 为 2-16，dst 可以与 src 为同一图像
+        static bool boxReduce(const cv::Mat &src, cv::Mat &dst, int factor);
+
+        // 取得一个方向的抽头表，缓存中没有时计算并加入缓存
+        static std::shared_ptr<const ResampleTaps> taps(int src_size, int dst_size, ResampleFilter filter);
+
+        // 缓存管理
+        static void clearCache();
+        static size_t cacheSize();
+    };
+
+} // namespace image_processor
+
+#endif // RESAMPLER_HPP
@@ -0,0 +1,73 @@
+#ifndef SIMD_KERNELS_HPP
+#define SIMD_KERNELS_HPP
+
+#include <opencv2/core/mat.hpp>
+#include <string>
+
+namespace image_processor
+{
+
+    // 定点数灰度权重（Q14，三个权重之和为 1 << 14）
+    struct FixedPointWeights
+    {
+        int b;
+        int g;
+        int r;
+    };
+
+    // 饱和度系数：BGR 交错数据中每个输出字节是相邻 5 个字节的加权和（Q13）
+    // taps[c][d] 为通道 c 的输出对偏移 d-2 处输入的系数
+    struct SaturationCoefficients
+    {
+        int taps[3][5];
+    };
+
+    // 行级 SIMD 内核：在运行时根据 CPU 支持情况选择 AVX2 / SSE2 / 标量实现
+    class SimdKernels
+    {
+    public:
+        static const int GRAY_WEIGHT_SHIFT = 14;
+
+        // 将归一化后的权重转换为定点数，权重过大无法用定点数表示时返回 false
+        static bool toFixedPointWeights(double weight_r, double weight_g, double weight_b, FixedPointWeights &weights);
+
+        // 对一行 BGR 像素做加权灰度化（结果截断取整并饱和到 0-255）
+        static void weightedGrayRow(const uchar *src, uchar *dst, int width, const FixedPointWeights &weights);
+
+        static const int SATURATION_SHIFT = 13;
+
+        // 根据饱和度系数（1.0 为不变）生成朝亮度插值的系数表
+        static void makeSaturationCoefficients(double factor, SaturationCoefficients &coefficients);
+
+        // 对一行 BGR 像素调整饱和度：out = Y + (in - Y) * factor
+        static void saturationRow(const uchar *src, uchar *dst, int width, const SaturationCoefficients &coefficients);
+
+        static const int RESAMPLE_WEIGHT_SHIFT = 14;
+        static const int RESAMPLE_INTERMEDIATE_BITS = 6;
+
+        // 水平重采样一行（channels 为 1、3 或 4）：输出像素 x 的各通道 = sum(weights[x * taps + k] * src[starts[x] + k])，
+        // 权重为 Q14 定点数；结果为带 RESAMPLE_INTERMEDIATE_BITS 位小数的 16 位中间值，保留滤波器的过冲
+        static void resampleHorizontalRow(const uchar *src, short *dst, int width, int channels, const int *starts,
+                                          const short *weights, int taps);
+
+        // 垂直重采样一行中间值：dst[e] = sum(weights[k] * rows[k][e])，k < taps，e < count，结果四舍五入并饱和到 0-255
+        static void resampleVerticalRow(const short *const *rows, const short *weights, int taps, uchar *dst, int count);
+
+        // 2x2 方框缩小一行：输出第 x 个像素为 row0、row1 中第 2x、2x+1 个像素（共 4 个）的均值，四舍五入；width 为输出像素数
+        static void halveRow(const uchar *row0, const uchar *row1, uchar *dst, int width, int channels);
+
+        // 整数倍像素复制一行：输入的每个像素在输出中重复 factor 次；width 为输入像素数
+        static void replicateRow(const uchar *src, uchar *dst, int width, int channels, int factor);
+
+        // 整数倍方框缩小一行：输出第 x 个像素为 rows[0..factor) 中第 x * factor 起 factor 个像素的均值；
+        // 取整方式与 cv::resize 区域插值一致（2 倍为四舍五入，3 倍以上为 cvRound 的五成双）
+        // width 为输出像素数，factor 不超过 16，channels 不超过 4
+        static void boxReduceRow(const uchar *const *rows, int factor, uchar *dst, int width, int channels);
+
+        // 当前使用的指令集名称
+        static std::string activeInstructionSet();
+    };
+
+} // namespace image_processor
+
+#endif // SIMD_KERNELS_HPP
@@ -0,0 +1,43 @@
+#ifndef SPATIAL_FILTERS_HPP
+#define SPATIAL_FILTERS_HPP
+
+#include <opencv2/core/mat.hpp>
+
+namespace image_processor
+{
+
+    // 空间滤波：模糊与锐化
+    // 支持 8U/16U/32F 深度和 1/3/4 通道，图像边界外按最近的边缘像素处理；
+    // 模糊对 BGRA 图像的 Alpha 通道一同滤波，锐化只作用于颜色通道、Alpha 通道原样保留
+    // 与 ColorProcessing 相同，每个操作都有返回新图像和写入 dst 的两种形式，dst 可以与输入为同一图像
+    class SpatialFilters
+    {
+    public:
+        // 方框模糊：窗口为 (2 * radius + 1) 的正方形
+        // 行方向和列方向都使用滑动窗口累加和，每个像素的计算量与半径无关
+        static cv::Mat boxBlur(const cv::Mat &image, int radius);
+        static bool boxBlur(const cv::Mat &image, cv::Mat &dst, int radius);
+
+        // 高斯模糊：sigma 较小时使用可分离卷积，较大时使用三阶递归（IIR）滤波，计算量与 sigma 无关
+        static cv::Mat gaussianBlur(const cv::Mat &image, double sigma);
+        static bool gaussianBlur(const cv::Mat &image, cv::Mat &dst, double sigma);
+
+        // USM 锐化：原图 + amount * (原图 - 高斯模糊)，radius 为高斯模糊的 sigma；
+        // 与模糊结果相差小于 threshold（以 8 位色阶为单位）的像素保持不变，避免放大噪声
+        static cv::Mat unsharpMask(const cv::Mat &image, double radius, double amount, double threshold = 0.0);
+        static bool unsharpMask(const cv::Mat &image, cv::Mat &dst, double radius, double amount, double threshold = 0.0);
+
+        // 锐化：原图 + amount * (原图 - 3x3 邻域均值)
+        static cv::Mat sharpen(const cv::Mat &image, double amount);
+        static bool sharpen(const cv::Mat &image, cv::Mat &dst, double amount);
+
+        // 导向滤波（各通道以自身为引导图）：保边平滑/降噪
+        // eps 为以满量程为 1 计的方差阈值：邻域方差远小于 eps 的平坦区域被平滑，远大于 eps 的边缘被保留；
+        // 由四次方框滤波组成，计算量与半径无关；BGRA 图像的 Alpha 通道原样保留
+        static cv::Mat guidedFilter(const cv::Mat &image, int radius, double eps);
+        static bool guidedFilter(const cv::Mat &image, cv::Mat &dst, int radius, double eps);
+    };
+
+} // namespace image_processor
+
+#endif // SPATIAL_FILTERS_HPP
@@ -0,0 +1,153 @@
+#ifndef SRGB_TABLES_HPP
+#define SRGB_TABLES_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace image_processor
+{
+
+    // sRGB 传递函数及编译期生成的查找表，供线性光模式在条带上转换，不需要逐像素调用 pow()
+    // 8 位：256 项 sRGB -> 16 位线性值，以及 12 位线性值索引的 4096 项线性 -> 8 位 sRGB（往返逐位无损）
+    // 16 位和浮点：4097 项的浮点表，相邻表项之间线性插值
+    class SrgbTransfer
+    {
+    public:
+        static constexpr int LINEAR_INDEX_BITS = 12;
+        static constexpr int FLOAT_TABLE_STEPS = 4096;
+
+        // sRGB 编码值（[0, 1]）转换为线性光
+        static constexpr double toLinear(double value)
+        {
+            return value <= 0.04045 ? value / 12.92 : power((value + 0.055) / 1.055, 2.4);
+        }
+
+        // 线性光（[0, 1]）转换为 sRGB 编码值
+        static constexpr double toSrgb(double value)
+        {
+            return value <= 0.0031308 ? value * 12.92 : 1.055 * power(value, 1.0 / 2.4) - 0.055;
+        }
+
+        // 浮点表插值，输入截断到 [0, 1]
+        static float interpolate(const std::array<float, FLOAT_TABLE_STEPS + 1> &table, float value)
+        {
+            float x = std::min(std::max(value, 0.f), 1.f) * FLOAT_TABLE_STEPS;
+            int index = std::min(static_cast<int>(x), FLOAT_TABLE_STEPS - 1);
+            return table[index] + (x - index) * (table[index + 1] - table[index]);
+        }
+
+        // 编译期可用的自然对数和指数（标准库的数学函数不是 constexpr）
+        static constexpr double logarithm(double x)
+        {
+            // 规约到 [0.5, 1) 后使用 atanh 级数
+            int exponent = 0;
+            while (x >= 1.0)
+            {
+                x *= 0.5;
+                ++exponent;
+            }
+            while (x < 0.5)
+            {
+                x *= 2.0;
+                --exponent;
+            }
+            double t = (x - 1.0) / (x + 1.0);
+            double t2 = t * t;
+            double term = t;
+            double sum = 0.0;
+            for (int n = 1; n < 40; n += 2)
+            {
+                sum += term / n;
+                term *= t2;
+            }
+            return 2.0 * sum + exponent * LN2;
+        }
+
+        static constexpr double exponential(double y)
+        {
+            // 规约为 2^k * e^r，|r| <= ln2 / 2 后使用泰勒级数
+            int k = static_cast<int>(y / LN2 + (y < 0 ? -0.5 : 0.5));
+            double r = y - k * LN2;
+            double term = 1.0;
+            double sum = 1.0;
+            for (int n = 1; n < 20; ++n)
+            {
+                term *= r / n;
+                sum += term;
+            }
+            for (; k > 0; --k)
+            {
+                sum *= 2.0;
+            }
+            for (; k < 0; ++k)
+            {
+                sum *= 0.5;
+            }
+            return sum;
+        }
+
+        static constexpr double power(double x, double p)
+        {
+            return x <= 0.0 ? 0.0 : exponential(p * logarithm(x));
+        }
+
+    private:
+        static constexpr double LN2 = 0.693147180559945309417;
+    };
+
+    namespace srgb_tables_detail
+    {
+        constexpr std::array<std::uint16_t, 256> makeSrgb8ToLinear16()
+        {
+            std::array<std::uint16_t, 256> table{};
+            for (int i = 0; i < 256; ++i)
+            {
+                table[i] = static_cast<std::uint16_t>(SrgbTransfer::toLinear(i / 255.0) * 65535.0 + 0.5);
+            }
+            return table;
+        }
+
+        constexpr std::array<std::uint8_t, 1 << SrgbTransfer::LINEAR_INDEX_BITS> makeLinear12ToSrgb8()
+        {
+            // 每个表项覆盖 16 个 16 位线性值，取区间中点计算
+            constexpr int size = 1 << SrgbTransfer::LINEAR_INDEX_BITS;
+            constexpr int bucket = 1 << (16 - SrgbTransfer::LINEAR_INDEX_BITS);
+            std::array<std::uint8_t, size> table{};
+            for (int i = 0; i < size; ++i)
+            {
+                double linear = (i * bucket + (bucket - 1) * 0.5) / 65535.0;
+                table[i] = static_cast<std::uint8_t>(SrgbTransfer::toSrgb(linear) * 255.0 + 0.5);
+            }
+            return table;
+        }
+
+        template <bool ToLinear>
+        constexpr std::array<float, SrgbTransfer::FLOAT_TABLE_STEPS + 1> makeFloatTable()
+        {
+            std::array<float, SrgbTransfer::FLOAT_TABLE_STEPS + 1> table{};
+            for (int i = 0; i <= SrgbTransfer::FLOAT_TABLE_STEPS; ++i)
+            {
+                double value = static_cast<double>(i) / SrgbTransfer::FLOAT_TABLE_STEPS;
+                table[i] = static_cast<float>(ToLinear ? SrgbTransfer::toLinear(value) : SrgbTransfer::toSrgb(value));
+            }
+            return table;
+        }
+    }
+
+    // 8 位 sRGB -> 16 位线性光
+    inline constexpr std::array<std::uint16_t, 256> SRGB8_TO_LINEAR16 = srgb_tables_detail::makeSrgb8ToLinear16();
+
+    // 16 位线性光的高 12 位 -> 8 位 sRGB
+    inline constexpr std::array<std::uint8_t, 1 << SrgbTransfer::LINEAR_INDEX_BITS> LINEAR12_TO_SRGB8 =
+        srgb_tables_detail::makeLinear12ToSrgb8();
+
+    // [0, 1] 上等距采样的浮点表（16 位和浮点图像插值使用）
+    inline constexpr std::array<float, SrgbTransfer::FLOAT_TABLE_STEPS + 1> SRGB_TO_LINEAR_FLOAT =
+        srgb_tables_detail::makeFloatTable<true>();
+    inline constexpr std::array<float, SrgbTransfer::FLOAT_TABLE_STEPS + 1> LINEAR_TO_SRGB_FLOAT =
+        srgb_tables_detail::makeFloatTable<false>();
+
+} // namespace image_processor
+
+#endif // SRGB_TABLES_HPP
@@ -0,0 +1,41 @@
+#ifndef TILED_EXECUTOR_HPP
+#define TILED_EXECUTOR_HPP
+
+#include <opencv2/core/mat.hpp>
+#include "color_pipeline.hpp"
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+namespace image_processor
+{
+
+    // 大图分块执行器：把“颜色图层 + 缩放”整条处理链放在同一组缓存大小的条带上完成
+    // 每个条带从读取原图、执行颜色图层到缩放写出都留在缓存中，颜色处理的中间结果不再写回内存；
+    // 条带按缩放比例对齐并带有插值所需的重叠行，结果与先整图调色再整图缩放一致
+    class TiledExecutor
+    {
+    public:
+        // 判断该处理链能否分块执行（图像足够大、图层均为逐像素操作且缩放比例可对齐）
+        // 内置重采样器和会建立金字塔的区域插值缩小（4 倍以上）不分块，保证结果与 ImageScaling::scaleImage 一致
+        static bool canTile(const cv::Mat &image, const ColorPipeline &pipeline,
+                            int new_width, int new_height, const std::string &method = "default");
+
+        // 分块执行颜色图层和缩放，结果写入 dst（dst 不能与 image 共享内存）
+        static bool run(const cv::Mat &image, cv::Mat &dst, const ColorPipeline &pipeline,
+                        int new_width, int new_height, const std::string &method = "default");
+
+        // 设置启用分块执行的最小像素数
+        static void setMinTiledPixels(size_t pixels);
+        static size_t minTiledPixels();
+
+    private:
+        static std::atomic<size_t> min_tiled_pixels_;
+
+        // 辅助函数：插值在每侧需要额外读取的原图行数
+        static int interpolationMargin(int interpolation);
+    };
+
+} // namespace image_processor
+
+#endif // TILED_EXECUTOR_HPP
@@ -2,6 +2,8 @@
 #define WEB_SERVER_HPP
 
 #include <crow.h>
+#include <crow/multipart.h>
+#include "color_pipeline.hpp"
 #include <opencv2/opencv.hpp>
 #include <string>
 
@@ -27,19 +29,40 @@ namespace image_processor
         crow::response handleUpload(const crow::request &req);
         crow::response handleProcess(const crow::request &req);
         crow::response handleDownload(const crow::request &req);
+        crow::response handleStats(const crow::request &req);
 
-        // 辅助处理函数
-        void processColorOperations(const crow::json::rvalue &params_json, cv::Mat &processed_image);
-        void processGrayscaleOperation(const crow::json::rvalue &colorOp, cv::Mat &processed_image);
-        void processBrightnessOperation(const crow::json::rvalue &colorOp, cv::Mat &processed_image);
-        void processContrastOperation(const crow::json::rvalue &colorOp, cv::Mat &processed_image);
-        void processSaturationOperation(const crow::json::rvalue &colorOp, cv::Mat &processed_image);
-        void processInvertOperation(const crow::json::rvalue &colorOp, cv::Mat &processed_image);
-        void processScaleOperations(const crow::json::rvalue &params_json, cv::Mat &processed_image);
+        // 辅助处理函数（image 与 buffer 为两块交替使用的缓冲区，处理结果始终位于 image 中）
+        void processColorOperations(const crow::json::rvalue &params_json, cv::Mat &image, cv::Mat &buffer);
+        void buildColorPipeline(const crow::json::rvalue &params_json, ColorPipeline &pipeline);
+        void addColorOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline);
+        void processGrayscaleOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline);
+        void processBrightnessOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline);
+        void processContrastOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline);
+        void processSaturationOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline);
+        void processInvertOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline);
+        void processEqualizeOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline);
+        void processLut3DOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline);
+        void processAutoLevelsOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline);
+        void processAutoWhiteBalanceOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline);
+        void processBlurOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline);
+        void processGaussianBlurOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline);
+        void processUnsharpMaskOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline);
+        void processSharpenOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline);
+        void processGuidedFilterOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline);
+        void processRankFilterOperation(const std::string &operation, const crow::json::rvalue &colorOp, ColorPipeline &pipeline);
+        void processConvolutionOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline);
+        void processBinarizeOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline);
+        void processScaleOperations(const crow::json::rvalue &params_json, cv::Mat &image, cv::Mat &buffer);
+        bool resolveScaleSize(const crow::json::rvalue &params_json, const cv::Size &image_size,
+                              int &width, int &height, std::string &method);
+        bool processTiledOperations(const crow::json::rvalue &params_json, cv::Mat &image, cv::Mat &buffer);
+        bool processPlannedOperations(const crow::json::rvalue &params_json, cv::Mat &image, cv::Mat &buffer);
 
         // 工具函数
         std::string generateResponse(bool success, const std::string &message, const std::string &data = "");
         cv::Mat stringToImage(const std::string &image_data);
+        cv::Mat decodeImage(const std::vector<uchar> &data, bool high_precision);
+        cv::Mat decodeRequest(const crow::multipart::message &msg, crow::json::rvalue &params_json, bool &has_params);
         std::string imageToString(const cv::Mat &image);
     };
 
@@ -0,0 +1,403 @@
+#include "binarization.hpp"
+#include "logger.hpp"
+#include "parallel.hpp"
+#include "pixel_kernels.hpp"
+#include "simd_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace image_processor
+{
+
+    namespace
+    {
+        // 自适应阈值的半径上限；窗口和使用 32 位无符号整数累加，最大窗口内的亮度和约为 2001^2 * 255 < 2^32
+        const int MAX_ADAPTIVE_RADIUS = 1000;
+
+        // 检查图像格式，不满足时输出错误日志
+        bool checkImage(const cv::Mat &image, const std::string &operation)
+        {
+            if (image.empty())
+            {
+                Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot apply " + operation + " to empty image");
+                return false;
+            }
+
+            int depth = image.depth();
+            int channels = image.channels();
+            if (!((depth == CV_8U || depth == CV_16U || depth == CV_32F) && (channels == 1 || channels == 3 || channels == 4)))
+            {
+                Logger::log(LogLevel::IP_LOGLV_ERROR, "Unsupported image format for " + operation);
+                return false;
+            }
+            return true;
+        }
+
+        // 把一行像素换算为 8 位亮度：8 位图像使用与灰度化 SIMD 内核相同的定点数权重，其他深度按满量程缩放
+        template <typename T, int CN>
+        void lumaRow(const T *src, uchar *dst, int width, const FixedPointWeights &weights, float scale)
+        {
+            for (int j = 0; j < width; ++j, src += CN)
+            {
+                if (CN == 1)
+                {
+                    dst[j] = cv::saturate_cast<uchar>(src[0] * scale);
+                }
+                else if (std::is_same<T, uchar>::value)
+                {
+                    int sum = src[0] * weights.b + src[1] * weights.g + src[2] * weights.r;
+                    dst[j] = cv::saturate_cast<uchar>(sum >> SimdKernels::GRAY_WEIGHT_SHIFT);
+                }
+                else
+                {
+                    dst[j] = cv::saturate_cast<uchar>((0.114f * src[0] + 0.587f * src[1] + 0.299f * src[2]) * scale);
+                }
+            }
+        }
+
+        // 逐行读取图像的 8 位亮度：8 位单通道图像直接返回原行，8 位 BGR 图像使用 SIMD 内核，其余格式使用模板内核
+        class LumaReader
+        {
+        public:
+            explicit LumaReader(const cv::Mat &image)
+                : image_(image), scale_(static_cast<float>(255.0 / PixelKernels::maxValue(image.depth())))
+            {
+                SimdKernels::toFixedPointWeights(0.299, 0.587, 0.114, weights_);
+            }
+
+            // buffer 至少为 image.cols 字节
+            const uchar *row(int i, uchar *buffer) const
+            {
+                if (image_.type() == CV_8UC1)
+                {
+                    return image_.ptr<uchar>(i);
+                }
+                if (image_.type() == CV_8UC3)
+                {
+                    SimdKernels::weightedGrayRow(image_.ptr<uchar>(i), buffer, image_.cols, weights_);
+                    return buffer;
+                }
+                PixelKernels::dispatch(image_.depth(), image_.channels(), [&](auto format)
+                                       {
+                    typedef typename decltype(format)::value_type T;
+                    constexpr int CN = decltype(format)::channels;
+                    lumaRow<T, CN>(image_.ptr<T>(i), buffer, image_.cols, weights_, scale_); });
+                return buffer;
+            }
+
+        private:
+            const cv::Mat &image_;
+            FixedPointWeights weights_;
+            float scale_;
+        };
+
+        // 亮度大于 level 的像素写为 high，其余写为 low（内层循环可以向量化）
+        inline void compareRow(const uchar *gray, uchar *out, int width, int level, uchar high, uchar low)
+        {
+            for (int j = 0; j < width; ++j)
+            {
+                out[j] = gray[j] > level ? high : low;
+            }
+        }
+
+        // 按全局阈值输出二值图像；原图的引用先于 dst 的重新分配保留，原地调用时也能读取原图
+        void applyLevel(const cv::Mat &image, cv::Mat &dst, int level, bool invert)
+        {
+            cv::Mat input = image;
+            dst.create(input.rows, input.cols, CV_8UC1);
+            LumaReader reader(input);
+            uchar high = invert ? 0 : 255;
+            uchar low = invert ? 255 : 0;
+            Parallel::forEachRowBand(input, [&](const cv::Range &rows)
+                                     {
+                std::vector<uchar> buffer(input.cols);
+                for (int i = rows.start; i < rows.end; ++i)
+                {
+                    compareRow(reader.row(i, buffer.data()), dst.ptr<uchar>(i), input.cols, level, high, low);
+                } });
+        }
+
+        // 由 256 级直方图求大津法阈值：取使类间方差 w0 * w1 * (mu0 - mu1)^2 最大的 t（亮度 <= t 为背景）
+        int otsuLevel(const uint64_t histogram[256])
+        {
+            double total = 0.0;
+            double total_sum = 0.0;
+            for (int v = 0; v < 256; ++v)
+            {
+                total += static_cast<double>(histogram[v]);
+                total_sum += static_cast<double>(v) * static_cast<double>(histogram[v]);
+            }
+
+            double weight = 0.0;
+            double sum = 0.0;
+            double best = -1.0;
+            int level = 0;
+            for (int t = 0; t < 255; ++t)
+            {
+                weight += static_cast<double>(histogram[t]);
+                sum += static_cast<double>(t) * static_cast<double>(histogram[t]);
+                double other = total - weight;
+                if (weight == 0.0 || other == 0.0)
+                {
+                    continue;
+                }
+                double difference = sum / weight - (total_sum - sum) / other;
+                double variance = weight * other * difference * difference;
+                if (variance > best)
+                {
+                    best = variance;
+                    level = t;
+                }
+            }
+            return level;
+        }
+
+        // 自适应阈值第一步（按行带）：把每行换算为 8 位亮度，并求行方向的窗口和（窗口只统计图像内的像素）
+        // 窗口和由前一个像素的窗口和加上进入窗口的像素、减去离开窗口的像素得到，每个像素的计算量与半径无关
+        void adaptiveRowSums(const LumaReader &reader, cv::Mat &gray, cv::Mat &sums, const cv::Range &rows, int radius)
+        {
+            int width = gray.cols;
+            for (int y = rows.start; y < rows.end; ++y)
+            {
+                uchar *gray_row = gray.ptr<uchar>(y);
+                const uchar *luma = reader.row(y, gray_row);
+                if (luma != gray_row)
+                {
+                    std::copy(luma, luma + width, gray_row);
+                }
+
+                uint32_t *sum_row = sums.ptr<uint32_t>(y);
+                uint32_t sum = 0;
+                for (int x = 0; x < std::min(radius, width); ++x)
+                {
+                    sum += gray_row[x];
+                }
+                for (int x = 0; x < width; ++x)
+                {
+                    if (x + radius < width)
+                    {
+                        sum += gray_row[x + radius];
+                    }
+                    if (x - radius - 1 >= 0)
+                    {
+                        sum -= gray_row[x - radius - 1];
+                    }
+                    sum_row[x] = sum;
+                }
+            }
+        }
+
+        // 自适应阈值第二步（按列块）：自上而下扫描，列方向的窗口和保存为一行累加器，每行只加上进入窗口的行、
+        // 减去离开窗口的行，再与窗口内的亮度均值减 offset 比较；内层循环沿连续内存可以向量化
+        // 每行先读取亮度再写出结果，各列块只读写自己的列，dst 与亮度图像为同一图像时也不会读到已写出的值
+        void adaptiveColumns(const cv::Mat &gray, const cv::Mat &sums, cv::Mat &dst, int first, int last, int radius,
+                             double offset, uchar high, uchar low)
+        {
+            int height = sums.rows;
+            int width = sums.cols;
+            int count = last - first;
+            std::vector<uint32_t> sum(count, 0);
+            std::vector<int> columns(count);
+            for (int e = 0; e < count; ++e)
+            {
+                int x = first + e;
+                columns[e] = std::min(x + radius + 1, width) - std::max(x - radius, 0);
+            }
+
+            for (int k = 0; k < std::min(radius, height); ++k)
+            {
+                const uint32_t *row = sums.ptr<uint32_t>(k) + first;
+                for (int e = 0; e < count; ++e)
+                {
+                    sum[e] += row[e];
+                }
+            }
+
+            for (int y = 0; y < height; ++y)
+            {
+                if (y + radius < height)
+                {
+                    const uint32_t *enter_row = sums.ptr<uint32_t>(y + radius) + first;
+                    for (int e = 0; e < count; ++e)
+                    {
+                        sum[e] += enter_row[e];
+                    }
+                }
+                if (y - radius - 1 >= 0)
+                {
+                    const uint32_t *leave_row = sums.ptr<uint32_t>(y - radius - 1) + first;
+                    for (int e = 0; e < count; ++e)
+                    {
+                        sum[e] -= leave_row[e];
+                    }
+                }
+
+                double rows = static_cast<double>(std::min(y + radius + 1, height) - std::max(y - radius, 0));
+                const uchar *gray_row = gray.ptr<uchar>(y) + first;
+                uchar *out = dst.ptr<uchar>(y) + first;
+                for (int e = 0; e < count; ++e)
+                {
+                    double area = rows * columns[e];
+                    out[e] = (gray_row[e] + offset) * area > static_cast<double>(sum[e]) ? high : low;
+                }
+            }
+        }
+    }
+
+    cv::Mat Binarization::threshold(const cv::Mat &image, double threshold, bool invert)
+    {
+        cv::Mat result;
+        return Binarization::threshold(image, result, threshold, invert) ? result : cv::Mat();
+    }
+
+    bool Binarization::threshold(const cv::Mat &image, cv::Mat &dst, double threshold, bool invert)
+    {
+        if (!checkImage(image, "threshold"))
+        {
+            return false;
+        }
+
+        if (threshold < 0.0 || threshold > 255.0)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Threshold must be between 0 and 255");
+            return false;
+        }
+
+        // 亮度为整数，大于 threshold 等价于大于其整数部分
+        int level = static_cast<int>(std::floor(threshold));
+        applyLevel(image, dst, level, invert);
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Threshold applied at level " + std::to_string(level));
+        return true;
+    }
+
+    cv::Mat Binarization::otsu(const cv::Mat &image, bool invert)
+    {
+        cv::Mat result;
+        return otsu(image, result, invert) ? result : cv::Mat();
+    }
+
+    bool Binarization::otsu(const cv::Mat &image, cv::Mat &dst, bool invert)
+    {
+        int level = 0;
+        if (!otsuThreshold(image, level))
+        {
+            return false;
+        }
+
+        applyLevel(image, dst, level, invert);
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Otsu threshold applied at level " + std::to_string(level));
+        return true;
+    }
+
+    bool Binarization::otsuThreshold(const cv::Mat &image, int &threshold)
+    {
+        if (!checkImage(image, "Otsu threshold"))
+        {
+            return false;
+        }
+
+        // 各行带在换算亮度的同一次遍历中统计局部直方图，最后合并；
+        // 交替累加到四个子直方图，避免相邻像素亮度相同时对同一计数器的读写相互等待
+        uint64_t histogram[256] = {};
+        std::mutex merge_mutex;
+        LumaReader reader(image);
+        Parallel::forEachRowBand(image, [&](const cv::Range &rows)
+                                 {
+            std::vector<uchar> buffer(image.cols);
+            std::vector<uint32_t> local(4 * 256, 0);
+            uint32_t *h0 = local.data();
+            uint32_t *h1 = h0 + 256;
+            uint32_t *h2 = h1 + 256;
+            uint32_t *h3 = h2 + 256;
+            for (int i = rows.start; i < rows.end; ++i)
+            {
+                const uchar *gray = reader.row(i, buffer.data());
+                int j = 0;
+                for (; j + 4 <= image.cols; j += 4)
+                {
+                    ++h0[gray[j]];
+                    ++h1[gray[j + 1]];
+                    ++h2[gray[j + 2]];
+                    ++h3[gray[j + 3]];
+                }
+                for (; j < image.cols; ++j)
+                {
+                    ++h0[gray[j]];
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(merge_mutex);
+            for (int v = 0; v < 256; ++v)
+            {
+                histogram[v] += static_cast<uint64_t>(h0[v]) + h1[v] + h2[v] + h3[v];
+            } });
+
+        threshold = otsuLevel(histogram);
+        return true;
+    }
+
+    cv::Mat Binarization::adaptive(const cv::Mat &image, int radius, double offset, bool invert)
+    {
+        cv::Mat result;
+        return adaptive(image, result, radius, offset, invert) ? result : cv::Mat();
+    }
+
+    bool Binarization::adaptive(const cv::Mat &image, cv::Mat &dst, int radius, double offset, bool invert)
+    {
+        if (!checkImage(image, "adaptive threshold"))
+        {
+            return false;
+        }
+
+        if (radius < 1 || radius > MAX_ADAPTIVE_RADIUS)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Radius for adaptive threshold must be between 1 and " +
+                                                      std::to_string(MAX_ADAPTIVE_RADIUS));
+            return false;
+        }
+
+        if (offset < -255.0 || offset > 255.0)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Offset for adaptive threshold must be between -255 and 255");
+            return false;
+        }
+
+        // 先按行带求亮度和行方向的窗口和，再按列块滑动列方向的窗口和；亮度和窗口和在整幅图像上只计算一次，
+        // 第二步不再读取原图，dst 可以与原图为同一图像。8 位单通道图像直接以原图作为亮度图像
+        cv::Mat input = image;
+        cv::Mat gray = input.type() == CV_8UC1 ? input : cv::Mat(input.rows, input.cols, CV_8UC1);
+        cv::Mat sums(input.rows, input.cols, CV_32SC1);
+        LumaReader reader(input);
+        Parallel::forEachRowBand(input, [&](const cv::Range &rows)
+                                 { adaptiveRowSums(reader, gray, sums, rows, radius); });
+
+        dst.create(input.rows, input.cols, CV_8UC1);
+        uchar high = invert ? 0 : 255;
+        uchar low = invert ? 255 : 0;
+        Parallel::forEachColumnBand(input, [&](const cv::Range &cols)
+                                    { adaptiveColumns(gray, sums, dst, cols.start, cols.end, radius, offset, high, low); });
+
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Adaptive threshold applied with radius " + std::to_string(radius));
+        return true;
+    }
+
+    bool Binarization::binarize(const cv::Mat &image, cv::Mat &dst, BinarizeMode mode, double threshold, int radius,
+                                double offset, bool invert)
+    {
+        switch (mode)
+        {
+        case BinarizeMode::OTSU:
+            return otsu(image, dst, invert);
+        case BinarizeMode::ADAPTIVE:
+            return adaptive(image, dst, radius, offset, invert);
+        default:
+            return Binarization::threshold(image, dst, threshold, invert);
+        }
+    }
+
+} // namespace image_processor
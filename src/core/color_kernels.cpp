@@ -0,0 +1,470 @@
+#include "color_kernels.hpp"
+#include "simd_kernels.hpp"
+#include "pixel_kernels.hpp"
+#include "srgb_tables.hpp"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace image_processor
+{
+
+    namespace
+    {
+        // 三维查找表一个维度上的格点偏移（以 float 为单位）和插值权重
+        struct LutAxis
+        {
+            int offset;
+            float frac;
+        };
+
+        // 把归一化后的分量定位到格点区间，超出值域的分量截断到边界；NaN 按 0 处理，避免对非有限值做整数转换
+        inline LutAxis locateLutAxis(float value, int size, int stride)
+        {
+            if (!(value >= 0.f))
+            {
+                value = 0.f;
+            }
+            float x = std::min(value, 1.f) * (size - 1);
+            int index = std::min(static_cast<int>(x), size - 2);
+            return {index * stride, x - index};
+        }
+
+        // 四面体插值：按三个小数部分从大到小确定从 c000 到 c111 的路径，只需四个顶点
+        inline void tetrahedral(const float *base, int dr, int dg, int db, float fr, float fg, float fb, float out[3])
+        {
+            const float *c1, *c2;
+            float w0, w1, w2, w3;
+            if (fr > fg)
+            {
+                if (fg > fb)
+                {
+                    c1 = base + dr, c2 = base + dr + dg;
+                    w0 = 1.f - fr, w1 = fr - fg, w2 = fg - fb, w3 = fb;
+                }
+                else if (fr > fb)
+                {
+                    c1 = base + dr, c2 = base + dr + db;
+                    w0 = 1.f - fr, w1 = fr - fb, w2 = fb - fg, w3 = fg;
+                }
+                else
+                {
+                    c1 = base + db, c2 = base + db + dr;
+                    w0 = 1.f - fb, w1 = fb - fr, w2 = fr - fg, w3 = fg;
+                }
+            }
+            else
+            {
+                if (fb > fg)
+                {
+                    c1 = base + db, c2 = base + db + dg;
+                    w0 = 1.f - fb, w1 = fb - fg, w2 = fg - fr, w3 = fr;
+                }
+                else if (fb > fr)
+                {
+                    c1 = base + dg, c2 = base + dg + db;
+                    w0 = 1.f - fg, w1 = fg - fb, w2 = fb - fr, w3 = fr;
+                }
+                else
+                {
+                    c1 = base + dg, c2 = base + dg + dr;
+                    w0 = 1.f - fg, w1 = fg - fr, w2 = fr - fb, w3 = fb;
+                }
+            }
+
+            const float *c111 = base + dr + dg + db;
+            for (int c = 0; c < 3; ++c)
+            {
+                out[c] = w0 * base[c] + w1 * c1[c] + w2 * c2[c] + w3 * c111[c];
+            }
+        }
+
+        // 逐通道转换并可改变元素类型：颜色通道使用 color，BGRA 的 Alpha 通道使用 alpha
+        template <typename S, typename D, int CN, typename Color, typename Alpha>
+        void mapChannels(const cv::Mat &src, cv::Mat &dst, Color color, Alpha alpha)
+        {
+            constexpr int COLOR_CN = CN == 4 ? 3 : CN;
+            for (int i = 0; i < src.rows; ++i)
+            {
+                const S *src_row = src.ptr<S>(i);
+                D *dst_row = dst.ptr<D>(i);
+                for (int j = 0; j < src.cols; ++j)
+                {
+                    for (int c = 0; c < COLOR_CN; ++c)
+                    {
+                        dst_row[j * CN + c] = color(src_row[j * CN + c]);
+                    }
+                    if constexpr (CN == 4)
+                    {
+                        dst_row[j * CN + 3] = alpha(src_row[j * CN + 3]);
+                    }
+                }
+            }
+        }
+
+        // 16 位和浮点图像通过插值浮点表转换
+        template <typename T>
+        void transferInterpolated(const cv::Mat &src, cv::Mat &dst,
+                                  const std::array<float, SrgbTransfer::FLOAT_TABLE_STEPS + 1> &table)
+        {
+            const float max_value = static_cast<float>(PixelTraits<T>::max_value);
+            auto color = [&table, max_value](T value)
+            { return cv::saturate_cast<T>(SrgbTransfer::interpolate(table, value / max_value) * max_value); };
+            auto alpha = [](T value)
+            { return value; };
+            PixelKernels::dispatchChannels<T>(src.channels(), [&](auto format)
+                                              { mapChannels<T, T, decltype(format)::channels>(src, dst, color, alpha); });
+        }
+    }
+
+    bool ColorKernels::isSupported(const cv::Mat &image)
+    {
+        int depth = image.depth();
+        int channels = image.channels();
+        return (depth == CV_8U || depth == CV_16U || depth == CV_32F) &&
+               (channels == 1 || channels == 3 || channels == 4);
+    }
+
+    int ColorKernels::grayscaleType(const cv::Mat &src)
+    {
+        return CV_MAKETYPE(src.depth(), src.channels() == 4 ? 4 : 1);
+    }
+
+    void ColorKernels::grayscale(const cv::Mat &src, cv::Mat &dst)
+    {
+        dst.create(src.rows, src.cols, grayscaleType(src));
+        if (src.channels() != 4)
+        {
+            cv::cvtColor(src, dst, cv::COLOR_BGR2GRAY);
+            return;
+        }
+
+        // BGRA 图像把亮度写回三个颜色通道并保留 Alpha；
+        // 整数图像使用与 cvtColor 相同的 14 位定点数系数，结果与 BGR 图像的灰度化逐位一致
+        PixelKernels::dispatch(src.depth(), 4, [&](auto format)
+                               {
+            typedef typename decltype(format)::value_type T;
+            auto luma = [](const T *src_pixel, T *dst_pixel)
+            {
+                T gray;
+                if constexpr (std::is_same<T, float>::value)
+                {
+                    gray = 0.114f * src_pixel[0] + 0.587f * src_pixel[1] + 0.299f * src_pixel[2];
+                }
+                else
+                {
+                    gray = static_cast<T>((src_pixel[0] * 1868 + src_pixel[1] * 9617 + src_pixel[2] * 4899 + (1 << 13)) >> 14);
+                }
+                dst_pixel[0] = dst_pixel[1] = dst_pixel[2] = gray;
+                dst_pixel[3] = src_pixel[3];
+            };
+            PixelKernels::transformRows<T, 4, 4>(src, dst, cv::Range(0, src.rows), luma); });
+    }
+
+    void ColorKernels::grayscaleCustom(const cv::Mat &src, cv::Mat &dst, double weight_r, double weight_g, double weight_b)
+    {
+        dst.create(src.rows, src.cols, grayscaleType(src));
+
+        // 8 位 BGR 图像使用定点数权重的向量化内核逐行计算加权平均
+        FixedPointWeights fixed_weights;
+        if (src.type() == CV_8UC3 && SimdKernels::toFixedPointWeights(weight_r, weight_g, weight_b, fixed_weights))
+        {
+            for (int i = 0; i < src.rows; ++i)
+            {
+                SimdKernels::weightedGrayRow(src.ptr<uchar>(i), dst.ptr<uchar>(i), src.cols, fixed_weights);
+            }
+            return;
+        }
+
+        // 其余深度、BGRA 图像或权重超出定点数范围时，使用通用逐像素内核计算加权平均
+        PixelKernels::dispatch(src.depth(), src.channels(), [&](auto format)
+                               {
+            typedef typename decltype(format)::value_type T;
+            constexpr int CN = decltype(format)::channels;
+            constexpr int DST_CN = CN == 4 ? 4 : 1;
+            if constexpr (CN >= 3)
+            {
+                auto weighted = [=](const T *src_pixel, T *dst_pixel)
+                {
+                    T gray = cv::saturate_cast<T>(weight_r * src_pixel[2] + weight_g * src_pixel[1] + weight_b * src_pixel[0]);
+                    if constexpr (CN == 4)
+                    {
+                        dst_pixel[3] = src_pixel[3];
+                        dst_pixel[1] = dst_pixel[2] = gray;
+                    }
+                    dst_pixel[0] = gray;
+                };
+                PixelKernels::transformRows<T, CN, DST_CN>(src, dst, cv::Range(0, src.rows), weighted);
+            } });
+    }
+
+    void ColorKernels::brightnessContrast(const cv::Mat &src, cv::Mat &dst, double alpha, double beta)
+    {
+        dst.create(src.rows, src.cols, src.type());
+        if (src.channels() != 4)
+        {
+            src.convertTo(dst, -1, alpha, beta);
+            return;
+        }
+
+        // BGRA 图像只变换颜色通道
+        PixelKernels::dispatch(src.depth(), 4, [&](auto format)
+                               {
+            typedef typename decltype(format)::value_type T;
+            auto linear = [=](const T *src_pixel, T *dst_pixel)
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    dst_pixel[c] = cv::saturate_cast<T>(alpha * src_pixel[c] + beta);
+                }
+                dst_pixel[3] = src_pixel[3];
+            };
+            PixelKernels::transformRows<T, 4, 4>(src, dst, cv::Range(0, src.rows), linear); });
+    }
+
+    void ColorKernels::channelLinear(const cv::Mat &src, cv::Mat &dst, const cv::Vec3d &alpha, const cv::Vec3d &beta)
+    {
+        dst.create(src.rows, src.cols, src.type());
+        PixelKernels::dispatch(src.depth(), src.channels(), [&](auto format)
+                               {
+            typedef typename decltype(format)::value_type T;
+            constexpr int CN = decltype(format)::channels;
+            constexpr int COLOR_CN = CN == 4 ? 3 : CN;
+            const double a[3] = {alpha[0], alpha[1], alpha[2]};
+            const double b[3] = {beta[0], beta[1], beta[2]};
+            auto linear = [&a, &b](const T *src_pixel, T *dst_pixel)
+            {
+                for (int c = 0; c < COLOR_CN; ++c)
+                {
+                    dst_pixel[c] = cv::saturate_cast<T>(a[c] * src_pixel[c] + b[c]);
+                }
+                if constexpr (CN == 4)
+                {
+                    dst_pixel[3] = src_pixel[3];
+                }
+            };
+            PixelKernels::transformRows<T, CN, CN>(src, dst, cv::Range(0, src.rows), linear); });
+    }
+
+    void ColorKernels::saturation(const cv::Mat &src, cv::Mat &dst, double factor, SaturationMode mode, cv::Mat &scratch)
+    {
+        dst.create(src.rows, src.cols, src.type());
+
+        if (mode == SaturationMode::HSV && src.channels() == 3 &&
+            (src.depth() == CV_8U || src.depth() == CV_32F))
+        {
+            // 转换到 HSV 空间调整饱和度通道（通道 1，取值范围为深度的满量程）后转换回来
+            double max_saturation = PixelKernels::maxValue(src.depth());
+            cv::cvtColor(src, scratch, cv::COLOR_BGR2HSV);
+            PixelKernels::dispatch(scratch.depth(), 3, [&](auto format)
+                                   {
+                typedef typename decltype(format)::value_type T;
+                auto adjust = [=](const T *src_pixel, T *dst_pixel)
+                {
+                    double new_saturation = src_pixel[1] * factor;
+                    // 确保值在有效范围内
+                    dst_pixel[1] = static_cast<T>(std::min(max_saturation, std::max(0.0, new_saturation)));
+                };
+                PixelKernels::transformRows<T, 3, 3>(scratch, scratch, cv::Range(0, scratch.rows), adjust); });
+            cv::cvtColor(scratch, dst, cv::COLOR_HSV2BGR);
+            return;
+        }
+
+        if (src.type() == CV_8UC3)
+        {
+            // 直接在 BGR 空间中把每个像素向其亮度插值
+            SaturationCoefficients coefficients;
+            SimdKernels::makeSaturationCoefficients(factor, coefficients);
+
+            // 内核会读取相邻像素，原地处理时先把当前行复制到行缓冲区
+            bool in_place = dst.data == src.data;
+            std::vector<uchar> row_buffer(in_place ? src.cols * 3 : 0);
+            for (int i = 0; i < src.rows; ++i)
+            {
+                const uchar *src_row = src.ptr<uchar>(i);
+                if (in_place)
+                {
+                    std::memcpy(row_buffer.data(), src_row, row_buffer.size());
+                    src_row = row_buffer.data();
+                }
+                SimdKernels::saturationRow(src_row, dst.ptr<uchar>(i), src.cols, coefficients);
+            }
+            return;
+        }
+
+        // 其余深度和 BGRA 图像使用通用逐像素内核
+        PixelKernels::dispatch(src.depth(), src.channels(), [&](auto format)
+                               {
+            typedef typename decltype(format)::value_type T;
+            constexpr int CN = decltype(format)::channels;
+            if constexpr (CN >= 3)
+            {
+                auto interpolate = [=](const T *src_pixel, T *dst_pixel)
+                {
+                    double luma = 0.114 * src_pixel[0] + 0.587 * src_pixel[1] + 0.299 * src_pixel[2];
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        dst_pixel[c] = cv::saturate_cast<T>(luma + factor * (src_pixel[c] - luma));
+                    }
+                    if constexpr (CN == 4)
+                    {
+                        dst_pixel[3] = src_pixel[3];
+                    }
+                };
+                PixelKernels::transformRows<T, CN, CN>(src, dst, cv::Range(0, src.rows), interpolate);
+            } });
+    }
+
+    void ColorKernels::invert(const cv::Mat &src, cv::Mat &dst)
+    {
+        dst.create(src.rows, src.cols, src.type());
+
+        // 无符号整数图像按位取反即为 满量程 - 像素值
+        if ((src.depth() == CV_8U || src.depth() == CV_16U) && src.channels() != 4)
+        {
+            cv::bitwise_not(src, dst);
+            return;
+        }
+
+        // 浮点图像和 BGRA 图像使用通用逐像素内核
+        PixelKernels::dispatch(src.depth(), src.channels(), [&](auto format)
+                               {
+            typedef typename decltype(format)::value_type T;
+            constexpr int CN = decltype(format)::channels;
+            constexpr int COLOR_CN = CN == 4 ? 3 : CN;
+            const T max_value = static_cast<T>(PixelTraits<T>::max_value);
+            auto complement = [=](const T *src_pixel, T *dst_pixel)
+            {
+                for (int c = 0; c < COLOR_CN; ++c)
+                {
+                    dst_pixel[c] = static_cast<T>(max_value - src_pixel[c]);
+                }
+                if constexpr (CN == 4)
+                {
+                    dst_pixel[3] = src_pixel[3];
+                }
+            };
+            PixelKernels::transformRows<T, CN, CN>(src, dst, cv::Range(0, src.rows), complement); });
+    }
+
+    void ColorKernels::srgbToLinear(const cv::Mat &src, cv::Mat &dst)
+    {
+        int depth = src.depth() == CV_8U ? CV_16U : src.depth();
+        dst.create(src.rows, src.cols, CV_MAKETYPE(depth, src.channels()));
+
+        if (src.depth() == CV_8U)
+        {
+            auto color = [](uchar value)
+            { return static_cast<ushort>(SRGB8_TO_LINEAR16[value]); };
+            auto alpha = [](uchar value)
+            { return static_cast<ushort>(value * 257); };
+            PixelKernels::dispatchChannels<uchar>(src.channels(), [&](auto format)
+                                                  { mapChannels<uchar, ushort, decltype(format)::channels>(src, dst, color, alpha); });
+        }
+        else if (src.depth() == CV_16U)
+        {
+            transferInterpolated<ushort>(src, dst, SRGB_TO_LINEAR_FLOAT);
+        }
+        else
+        {
+            transferInterpolated<float>(src, dst, SRGB_TO_LINEAR_FLOAT);
+        }
+    }
+
+    void ColorKernels::linearToSrgb(const cv::Mat &src, cv::Mat &dst, int depth)
+    {
+        dst.create(src.rows, src.cols, CV_MAKETYPE(depth, src.channels()));
+
+        if (src.depth() == CV_16U && depth == CV_8U)
+        {
+            // 8 位输出只需线性值的高 12 位
+            auto color = [](ushort value)
+            { return LINEAR12_TO_SRGB8[value >> (16 - SrgbTransfer::LINEAR_INDEX_BITS)]; };
+            auto alpha = [](ushort value)
+            { return static_cast<uchar>((value + 128) / 257); };
+            PixelKernels::dispatchChannels<ushort>(src.channels(), [&](auto format)
+                                                   { mapChannels<ushort, uchar, decltype(format)::channels>(src, dst, color, alpha); });
+        }
+        else if (src.depth() == CV_16U)
+        {
+            transferInterpolated<ushort>(src, dst, LINEAR_TO_SRGB_FLOAT);
+        }
+        else
+        {
+            transferInterpolated<float>(src, dst, LINEAR_TO_SRGB_FLOAT);
+        }
+    }
+
+    void ColorKernels::lut3D(const cv::Mat &src, cv::Mat &dst, const ColorLut3D &lut)
+    {
+        dst.create(src.rows, src.cols, src.type());
+
+        const int size = lut.size();
+        const int strides[3] = {3, size * 3, size * size * 3};
+        const float *table = lut.data();
+        const float *domain_min = lut.domainMin();
+        const float *domain_max = lut.domainMax();
+
+        PixelKernels::dispatch(src.depth(), src.channels(), [&](auto format)
+                               {
+            typedef typename decltype(format)::value_type T;
+            constexpr int CN = decltype(format)::channels;
+            if constexpr (CN >= 3)
+            {
+                const float max_value = static_cast<float>(PixelTraits<T>::max_value);
+                float scale[3], shift[3];
+                for (int c = 0; c < 3; ++c)
+                {
+                    scale[c] = 1.f / (max_value * (domain_max[c] - domain_min[c]));
+                    shift[c] = -domain_min[c] / (domain_max[c] - domain_min[c]);
+                }
+
+                // 8 位图像预先算好每个分量的格点偏移和权重，逐像素只剩查表和插值
+                std::vector<LutAxis> axes;
+                if constexpr (std::is_same<T, uchar>::value)
+                {
+                    axes.resize(3 * 256);
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        for (int v = 0; v < 256; ++v)
+                        {
+                            axes[c * 256 + v] = locateLutAxis(v * scale[c] + shift[c], size, strides[c]);
+                        }
+                    }
+                }
+
+                // 表项按 RGB 顺序存储，图像按 BGR 顺序存储
+                auto grade = [&](const T *src_pixel, T *dst_pixel)
+                {
+                    LutAxis r, g, b;
+                    if constexpr (std::is_same<T, uchar>::value)
+                    {
+                        r = axes[src_pixel[2]];
+                        g = axes[256 + src_pixel[1]];
+                        b = axes[512 + src_pixel[0]];
+                    }
+                    else
+                    {
+                        r = locateLutAxis(src_pixel[2] * scale[0] + shift[0], size, strides[0]);
+                        g = locateLutAxis(src_pixel[1] * scale[1] + shift[1], size, strides[1]);
+                        b = locateLutAxis(src_pixel[0] * scale[2] + shift[2], size, strides[2]);
+                    }
+
+                    float rgb[3];
+                    tetrahedral(table + r.offset + g.offset + b.offset, strides[0], strides[1], strides[2],
+                                r.frac, g.frac, b.frac, rgb);
+                    if constexpr (CN == 4)
+                    {
+                        dst_pixel[3] = src_pixel[3];
+                    }
+                    dst_pixel[0] = cv::saturate_cast<T>(rgb[2] * max_value);
+                    dst_pixel[1] = cv::saturate_cast<T>(rgb[1] * max_value);
+                    dst_pixel[2] = cv::saturate_cast<T>(rgb[0] * max_value);
+                };
+                PixelKernels::transformRows<T, CN, CN>(src, dst, cv::Range(0, src.rows), grade);
+            } });
+    }
+
+} // namespace image_processor
@@ -0,0 +1,252 @@
+#include "color_lut.hpp"
+#include "logger.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace image_processor
+{
+
+    namespace
+    {
+        // 缓存的查找表数量上限，超出时淘汰最早加入的表
+        const size_t MAX_CACHED_LUTS = 16;
+
+        // 格点数上限：常见的 .cube 文件为 17、33 或 65，65^3 个表项约占 3.3 MB；
+        // 查找表来自请求内容，更大的表会让单个请求占用数百 MB 内存
+        const int MAX_LUT_SIZE = 65;
+
+        // 缓存项保存原始文本，命中时逐字节比较，哈希碰撞的不同内容不会取到别的查找表
+        struct CachedLut
+        {
+            std::string text;
+            std::shared_ptr<const ColorLut3D> lut;
+        };
+
+        std::mutex cache_mutex;
+        std::unordered_map<uint64_t, CachedLut> cache;
+        std::deque<uint64_t> cache_order;
+
+        // 64 位 FNV-1a 哈希，长度也参与计算；只用于定位缓存项
+        uint64_t contentHash(const std::string &text)
+        {
+            uint64_t hash = 14695981039346656037ULL;
+            for (unsigned char c : text)
+            {
+                hash ^= c;
+                hash *= 1099511628211ULL;
+            }
+            return hash ^ static_cast<uint64_t>(text.size());
+        }
+
+        // 解析一行中的三个浮点数，成功返回 true
+        bool parseTriplet(const char *text, float values[3])
+        {
+            char *end = nullptr;
+            for (int i = 0; i < 3; ++i)
+            {
+                values[i] = std::strtof(text, &end);
+                if (end == text)
+                {
+                    return false;
+                }
+                text = end;
+            }
+            return true;
+        }
+    }
+
+    std::shared_ptr<const ColorLut3D> ColorLut3D::fromCube(const std::string &text)
+    {
+        uint64_t key = contentHash(text);
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            auto it = cache.find(key);
+            if (it != cache.end() && it->second.text == text)
+            {
+                Logger::log(LogLevel::IP_LOGLV_DEBUG, "3D LUT found in cache");
+                return it->second.lut;
+            }
+        }
+
+        // 在锁外解析，避免阻塞其他请求
+        std::shared_ptr<const ColorLut3D> lut = parse(text);
+        if (!lut)
+        {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        // 哈希相同但内容不同的查找表不加入缓存，已缓存的表保持不变
+        if (cache.emplace(key, CachedLut{text, lut}).second)
+        {
+            cache_order.push_back(key);
+            if (cache_order.size() > MAX_CACHED_LUTS)
+            {
+                cache.erase(cache_order.front());
+                cache_order.pop_front();
+            }
+        }
+        Logger::log(LogLevel::IP_LOGLV_INFO, "3D LUT parsed: " + std::to_string(lut->size()) + "^3 entries");
+        return lut;
+    }
+
+    std::shared_ptr<const ColorLut3D> ColorLut3D::loadCube(const std::string &filepath)
+    {
+        std::ifstream file(filepath, std::ios::binary);
+        if (!file)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot open 3D LUT file: " + filepath);
+            return nullptr;
+        }
+
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return fromCube(buffer.str());
+    }
+
+    void ColorLut3D::clearCache()
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        cache.clear();
+        cache_order.clear();
+    }
+
+    size_t ColorLut3D::cacheSize()
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        return cache.size();
+    }
+
+    int ColorLut3D::size() const
+    {
+        return size_;
+    }
+
+    const std::string &ColorLut3D::title() const
+    {
+        return title_;
+    }
+
+    const float *ColorLut3D::domainMin() const
+    {
+        return domain_min_;
+    }
+
+    const float *ColorLut3D::domainMax() const
+    {
+        return domain_max_;
+    }
+
+    const float *ColorLut3D::entry(int r, int g, int b) const
+    {
+        return table_.data() + ((static_cast<size_t>(b) * size_ + g) * size_ + r) * 3;
+    }
+
+    const float *ColorLut3D::data() const
+    {
+        return table_.data();
+    }
+
+    // 辅助函数：解析 .cube 文本，不使用缓存
+    std::shared_ptr<ColorLut3D> ColorLut3D::parse(const std::string &text)
+    {
+        std::shared_ptr<ColorLut3D> lut(new ColorLut3D());
+        size_t expected = 0;
+        std::istringstream stream(text);
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            // 跳过空行和注释
+            size_t start = line.find_first_not_of(" \t\r");
+            if (start == std::string::npos || line[start] == '#')
+            {
+                continue;
+            }
+
+            const char *content = line.c_str() + start;
+            float values[3];
+            if ((*content >= '0' && *content <= '9') || *content == '-' || *content == '+' || *content == '.')
+            {
+                if (lut->size_ == 0)
+                {
+                    Logger::log(LogLevel::IP_LOGLV_ERROR, "3D LUT data found before LUT_3D_SIZE");
+                    return nullptr;
+                }
+                if (lut->table_.size() >= expected * 3 || !parseTriplet(content, values))
+                {
+                    Logger::log(LogLevel::IP_LOGLV_ERROR, "Invalid 3D LUT entry: " + line);
+                    return nullptr;
+                }
+                lut->table_.insert(lut->table_.end(), values, values + 3);
+                continue;
+            }
+
+            std::istringstream keyword_stream(content);
+            std::string keyword;
+            keyword_stream >> keyword;
+            if (keyword == "TITLE")
+            {
+                size_t first = line.find('"');
+                size_t last = line.rfind('"');
+                if (first != std::string::npos && last > first)
+                {
+                    lut->title_ = line.substr(first + 1, last - first - 1);
+                }
+            }
+            else if (keyword == "LUT_3D_SIZE")
+            {
+                int size = 0;
+                keyword_stream >> size;
+                if (size < 2 || size > MAX_LUT_SIZE)
+                {
+                    Logger::log(LogLevel::IP_LOGLV_ERROR, "Invalid LUT_3D_SIZE: " + line);
+                    return nullptr;
+                }
+                lut->size_ = size;
+                expected = static_cast<size_t>(size) * size * size;
+                lut->table_.reserve(expected * 3);
+            }
+            else if (keyword == "DOMAIN_MIN" || keyword == "DOMAIN_MAX")
+            {
+                float *domain = keyword == "DOMAIN_MIN" ? lut->domain_min_ : lut->domain_max_;
+                if (!parseTriplet(content + keyword.size(), domain))
+                {
+                    Logger::log(LogLevel::IP_LOGLV_ERROR, "Invalid 3D LUT domain: " + line);
+                    return nullptr;
+                }
+            }
+            else if (keyword == "LUT_1D_SIZE")
+            {
+                Logger::log(LogLevel::IP_LOGLV_ERROR, "1D LUTs are not supported, expected a 3D LUT");
+                return nullptr;
+            }
+            else
+            {
+                Logger::log(LogLevel::IP_LOGLV_WARNING, "Unknown 3D LUT keyword ignored: " + keyword);
+            }
+        }
+
+        if (lut->size_ == 0 || lut->table_.size() != expected * 3)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Incomplete 3D LUT: expected " + std::to_string(expected) +
+                                                      " entries, got " + std::to_string(lut->table_.size() / 3));
+            return nullptr;
+        }
+
+        for (int c = 0; c < 3; ++c)
+        {
+            if (!(lut->domain_max_[c] > lut->domain_min_[c]))
+            {
+                Logger::log(LogLevel::IP_LOGLV_ERROR, "Invalid 3D LUT domain: DOMAIN_MAX must exceed DOMAIN_MIN");
+                return nullptr;
+            }
+        }
+        return lut;
+    }
+
+} // namespace image_processor
@@ -0,0 +1,786 @@
+#include "color_pipeline.hpp"
+#include "color_processing.hpp"
+#include "color_kernels.hpp"
+#include "convolution.hpp"
+#include "rank_filters.hpp"
+#include "spatial_filters.hpp"
+#include "logger.hpp"
+#include "parallel.hpp"
+#include "pixel_kernels.hpp"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <string>
+
+namespace image_processor
+{
+
+    namespace
+    {
+        // 每个条带包含的像素数，使条带及其中间缓冲区能够留在 L2 缓存中
+        const int STRIP_PIXELS = 16384;
+    }
+
+    void ColorPipeline::addGrayscale()
+    {
+        operations_.push_back({ColorOperationType::GRAYSCALE, {0.0, 0.0, 0.0}});
+    }
+
+    void ColorPipeline::addGrayscale(double weight_r, double weight_g, double weight_b)
+    {
+        operations_.push_back({ColorOperationType::GRAYSCALE_CUSTOM, {weight_r, weight_g, weight_b}});
+    }
+
+    void ColorPipeline::addBrightness(int brightness)
+    {
+        operations_.push_back({ColorOperationType::BRIGHTNESS, {static_cast<double>(brightness), 0.0, 0.0}});
+    }
+
+    void ColorPipeline::addContrast(int contrast)
+    {
+        operations_.push_back({ColorOperationType::CONTRAST, {static_cast<double>(contrast), 0.0, 0.0}});
+    }
+
+    void ColorPipeline::addSaturation(int saturation, SaturationMode mode)
+    {
+        operations_.push_back({ColorOperationType::SATURATION,
+                               {static_cast<double>(saturation), static_cast<double>(mode), 0.0}});
+    }
+
+    void ColorPipeline::addInvert()
+    {
+        operations_.push_back({ColorOperationType::INVERT, {0.0, 0.0, 0.0}});
+    }
+
+    void ColorPipeline::addEqualize(EqualizeMode mode, double clip_limit, int tile_grid)
+    {
+        operations_.push_back({ColorOperationType::EQUALIZE,
+                               {static_cast<double>(mode), clip_limit, static_cast<double>(tile_grid)}});
+    }
+
+    void ColorPipeline::addLut3D(std::shared_ptr<const ColorLut3D> lut)
+    {
+        if (!lut)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot add empty 3D LUT layer");
+            return;
+        }
+        operations_.push_back({ColorOperationType::LUT3D, {0.0, 0.0, 0.0}, std::move(lut)});
+    }
+
+    void ColorPipeline::addChannelLinear(const cv::Vec3d &alpha, const cv::Vec3d &beta)
+    {
+        operations_.push_back({ColorOperationType::CHANNEL_LINEAR, {alpha[0], alpha[1], alpha[2], beta[0], beta[1], beta[2]}});
+    }
+
+    void ColorPipeline::addAutoLevels(double clip_percent, int sample_step)
+    {
+        operations_.push_back({ColorOperationType::AUTO_LEVELS, {clip_percent, static_cast<double>(sample_step)}});
+    }
+
+    void ColorPipeline::addAutoWhiteBalance(int sample_step)
+    {
+        operations_.push_back({ColorOperationType::AUTO_WHITE_BALANCE, {static_cast<double>(sample_step)}});
+    }
+
+    void ColorPipeline::addBlur(int radius)
+    {
+        operations_.push_back({ColorOperationType::BLUR, {static_cast<double>(radius)}});
+    }
+
+    void ColorPipeline::addGaussianBlur(double sigma)
+    {
+        operations_.push_back({ColorOperationType::GAUSSIAN_BLUR, {sigma}});
+    }
+
+    void ColorPipeline::addUnsharpMask(double radius, double amount, double threshold)
+    {
+        operations_.push_back({ColorOperationType::UNSHARP_MASK, {radius, amount, threshold}});
+    }
+
+    void ColorPipeline::addSharpen(double amount)
+    {
+        operations_.push_back({ColorOperationType::SHARPEN, {amount}});
+    }
+
+    void ColorPipeline::addGuidedFilter(int radius, double eps)
+    {
+        operations_.push_back({ColorOperationType::GUIDED_FILTER, {static_cast<double>(radius), eps}});
+    }
+
+    void ColorPipeline::addDilate(int radius)
+    {
+        operations_.push_back({ColorOperationType::DILATE, {static_cast<double>(radius)}});
+    }
+
+    void ColorPipeline::addErode(int radius)
+    {
+        operations_.push_back({ColorOperationType::ERODE, {static_cast<double>(radius)}});
+    }
+
+    void ColorPipeline::addOpen(int radius)
+    {
+        operations_.push_back({ColorOperationType::OPEN, {static_cast<double>(radius)}});
+    }
+
+    void ColorPipeline::addClose(int radius)
+    {
+        operations_.push_back({ColorOperationType::CLOSE, {static_cast<double>(radius)}});
+    }
+
+    void ColorPipeline::addMedian(int radius)
+    {
+        operations_.push_back({ColorOperationType::MEDIAN, {static_cast<double>(radius)}});
+    }
+
+    void ColorPipeline::addConvolution(const cv::Mat &kernel, ConvolutionMethod method)
+    {
+        if (kernel.empty())
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot add empty convolution kernel layer");
+            return;
+        }
+        operations_.push_back({ColorOperationType::CONVOLVE, {static_cast<double>(method)}, nullptr,
+                               std::make_shared<const cv::Mat>(kernel.clone())});
+    }
+
+    void ColorPipeline::addBinarize(BinarizeMode mode, double threshold, int radius, double offset, bool invert)
+    {
+        operations_.push_back({ColorOperationType::BINARIZE, {static_cast<double>(mode), threshold,
+                                                              static_cast<double>(radius), offset, invert ? 1.0 : 0.0}});
+    }
+
+    void ColorPipeline::setLinearLight(bool enabled)
+    {
+        linear_light_ = enabled;
+    }
+
+    bool ColorPipeline::linearLight() const
+    {
+        return linear_light_;
+    }
+
+    bool ColorPipeline::empty() const
+    {
+        return operations_.empty();
+    }
+
+    size_t ColorPipeline::size() const
+    {
+        return operations_.size();
+    }
+
+    const std::vector<ColorOperation> &ColorPipeline::operations() const
+    {
+        return operations_;
+    }
+
+    ColorPipeline ColorPipeline::slice(size_t begin, size_t end) const
+    {
+        ColorPipeline pipeline;
+        pipeline.linear_light_ = linear_light_;
+        end = std::min(end, operations_.size());
+        if (begin < end)
+        {
+            pipeline.operations_.assign(operations_.begin() + begin, operations_.begin() + end);
+        }
+        return pipeline;
+    }
+
+    cv::Mat ColorPipeline::apply(const cv::Mat &image) const
+    {
+        cv::Mat result;
+        return apply(image, result) ? result : cv::Mat();
+    }
+
+    bool ColorPipeline::apply(const cv::Mat &image, cv::Mat &result) const
+    {
+        return run(image, result, false);
+    }
+
+    bool ColorPipeline::applyRegion(const cv::Mat &region, cv::Mat &result) const
+    {
+        return run(region, result, true);
+    }
+
+    int ColorPipeline::outputChannels(int input_channels) const
+    {
+        std::vector<Stage> stages;
+        int output_channels = input_channels;
+        if (!compileStages(CV_8U, input_channels, stages, output_channels, false))
+        {
+            return -1;
+        }
+        return output_channels;
+    }
+
+    bool ColorPipeline::isPointwise() const
+    {
+        // 饱和度内核只读取同一像素的三个通道；只有屏障图层依赖整幅图像或邻域像素
+        return std::none_of(operations_.begin(), operations_.end(), [](const ColorOperation &operation)
+                            { return isBarrier(operation.type); });
+    }
+
+    size_t ColorPipeline::pointwiseTail() const
+    {
+        for (size_t i = operations_.size(); i > 0; --i)
+        {
+            if (isBarrier(operations_[i - 1].type))
+            {
+                return i;
+            }
+        }
+        return 0;
+    }
+
+    // 辅助函数：该图层是否依赖整幅图像的统计量或邻域像素
+    bool ColorPipeline::isBarrier(ColorOperationType type)
+    {
+        return type == ColorOperationType::EQUALIZE || type == ColorOperationType::AUTO_LEVELS ||
+               type == ColorOperationType::AUTO_WHITE_BALANCE || isSpatial(type);
+    }
+
+    // 辅助函数：该图层是否为空间滤波
+    bool ColorPipeline::isSpatial(ColorOperationType type)
+    {
+        return type == ColorOperationType::BLUR || type == ColorOperationType::GAUSSIAN_BLUR ||
+               type == ColorOperationType::UNSHARP_MASK || type == ColorOperationType::SHARPEN ||
+               type == ColorOperationType::GUIDED_FILTER || type == ColorOperationType::DILATE ||
+               type == ColorOperationType::ERODE || type == ColorOperationType::OPEN ||
+               type == ColorOperationType::CLOSE || type == ColorOperationType::MEDIAN ||
+               type == ColorOperationType::CONVOLVE || type == ColorOperationType::BINARIZE;
+    }
+
+    // 辅助函数：执行全部图层；region 为 true 时在当前线程完成且不输出日志
+    bool ColorPipeline::run(const cv::Mat &image, cv::Mat &result, bool region) const
+    {
+        if (image.empty())
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot apply color pipeline to empty image");
+            return false;
+        }
+
+        if (!region && !isPointwise())
+        {
+            return applySegments(image, result);
+        }
+
+        // 条带融合处理 8 位/16 位/浮点的单通道、BGR 和 BGRA 图像，其余情况逐层调用
+        if (!ColorKernels::isSupported(image))
+        {
+            return applySequential(image, result);
+        }
+
+        std::vector<Stage> stages;
+        int output_channels = image.channels();
+        if (!compileStages(image.depth(), image.channels(), stages, output_channels, !region))
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Invalid weights for grayscale conversion: sum is zero");
+            return false;
+        }
+
+        if (stages.empty())
+        {
+            image.copyTo(result);
+            return true;
+        }
+
+        // 保留输入的引用，result 与输入为同一图像且通道数改变时重新分配不会影响读取
+        cv::Mat input = image;
+        result.create(input.rows, input.cols, CV_MAKETYPE(input.depth(), output_channels));
+        int strip_rows = std::max(1, STRIP_PIXELS / input.cols);
+
+        // 各行带并行执行；带内两个条带缓冲区交替作为输入和输出，最后一个图层直接写入结果图像
+        auto process_band = [&](const cv::Range &rows)
+        {
+            cv::Mat buffers[2];
+            cv::Mat scratch;
+            for (int row = rows.start; row < rows.end; row += strip_rows)
+            {
+                int row_end = std::min(rows.end, row + strip_rows);
+                cv::Mat current = input.rowRange(row, row_end);
+                cv::Mat output_strip = result.rowRange(row, row_end);
+
+                for (size_t i = 0; i < stages.size(); ++i)
+                {
+                    cv::Mat &target = (i + 1 == stages.size()) ? output_strip : buffers[i % 2];
+                    applyStage(stages[i], current, target, scratch);
+                    current = target;
+                }
+            }
+        };
+
+        if (region)
+        {
+            process_band(cv::Range(0, input.rows));
+            return true;
+        }
+
+        Parallel::forEachRowBand(input, process_band);
+        Logger::log(LogLevel::IP_LOGLV_INFO,
+                    "Color pipeline applied: " + std::to_string(operations_.size()) + " layers in a single pass");
+        return true;
+    }
+
+    // 辅助函数：在单个条带上执行一个阶段（src 与 dst 不可为同一缓冲区）
+    void ColorPipeline::applyStage(const Stage &stage, const cv::Mat &src, cv::Mat &dst, cv::Mat &scratch)
+    {
+        if (stage.transfer == Transfer::TO_LINEAR)
+        {
+            ColorKernels::srgbToLinear(src, dst);
+            return;
+        }
+        if (stage.transfer == Transfer::TO_SRGB)
+        {
+            ColorKernels::linearToSrgb(src, dst, stage.transfer_depth);
+            return;
+        }
+
+        if (stage.use_table)
+        {
+            stage.table.apply(src, dst);
+            return;
+        }
+
+        const ColorOperation &operation = stage.operation;
+        switch (operation.type)
+        {
+        case ColorOperationType::GRAYSCALE:
+            ColorKernels::grayscale(src, dst);
+            break;
+        case ColorOperationType::GRAYSCALE_CUSTOM:
+        {
+            double sum_weights = operation.params[0] + operation.params[1] + operation.params[2];
+            ColorKernels::grayscaleCustom(src, dst, operation.params[0] / sum_weights,
+                                          operation.params[1] / sum_weights, operation.params[2] / sum_weights);
+            break;
+        }
+        case ColorOperationType::SATURATION:
+            ColorKernels::saturation(src, dst, (operation.params[0] + 100.0) / 100.0,
+                                     static_cast<SaturationMode>(static_cast<int>(operation.params[1])), scratch);
+            break;
+        case ColorOperationType::BRIGHTNESS:
+            // 与 ColorProcessing::adjustBrightness 相同：偏移量以 8 位为单位，按深度换算到满量程
+            ColorKernels::brightnessContrast(src, dst, 1.0,
+                                             operation.params[0] * 2.0 * PixelKernels::maxValue(src.depth()) / 255.0);
+            break;
+        case ColorOperationType::CONTRAST:
+            ColorKernels::brightnessContrast(src, dst, (operation.params[0] + 100.0) / 100.0, 0.0);
+            break;
+        case ColorOperationType::INVERT:
+            ColorKernels::invert(src, dst);
+            break;
+        case ColorOperationType::LUT3D:
+            ColorKernels::lut3D(src, dst, *operation.lut);
+            break;
+        case ColorOperationType::CHANNEL_LINEAR:
+            ColorKernels::channelLinear(src, dst, cv::Vec3d(operation.params[0], operation.params[1], operation.params[2]),
+                                        cv::Vec3d(operation.params[3], operation.params[4], operation.params[5]));
+            break;
+        default:
+            break;
+        }
+    }
+
+    // 辅助函数：在均衡化图层处切分图层栈，各段分别单次遍历
+    bool ColorPipeline::applySegments(const cv::Mat &image, cv::Mat &result) const
+    {
+        // 第一段从输入读取并写入 result，之后的各段都在 result 上原地处理
+        cv::Mat input = image;
+        bool has_result = false;
+        ColorPipeline segment;
+        segment.setLinearLight(linear_light_);
+
+        auto flush_segment = [&]() -> bool
+        {
+            if (segment.empty())
+            {
+                return true;
+            }
+            bool ok = segment.apply(has_result ? result : input, result);
+            has_result = true;
+            segment.operations_.clear();
+            return ok;
+        };
+
+        for (const auto &operation : operations_)
+        {
+            if (!isBarrier(operation.type))
+            {
+                segment.operations_.push_back(operation);
+                continue;
+            }
+
+            if (!flush_segment())
+            {
+                return false;
+            }
+
+            if (operation.type == ColorOperationType::EQUALIZE || isSpatial(operation.type))
+            {
+                bool ok = operation.type == ColorOperationType::EQUALIZE
+                              ? applyEqualize(operation, has_result ? result : input, result)
+                              : applySpatial(operation, has_result ? result : input, result);
+                if (!ok)
+                {
+                    return false;
+                }
+                has_result = true;
+                continue;
+            }
+
+            // 自动色阶/白平衡：统计当前图像后换算为逐通道线性变换，作为下一段的第一个图层
+            ColorOperation resolved;
+            if (!resolveAutoOperation(operation, has_result ? result : input, resolved))
+            {
+                return false;
+            }
+            segment.operations_.push_back(resolved);
+        }
+
+        if (!flush_segment())
+        {
+            return false;
+        }
+        if (!has_result)
+        {
+            input.copyTo(result);
+        }
+        return true;
+    }
+
+    // 辅助函数：执行单个均衡化图层
+    bool ColorPipeline::applyEqualize(const ColorOperation &operation, const cv::Mat &image, cv::Mat &result)
+    {
+        if (static_cast<EqualizeMode>(static_cast<int>(operation.params[0])) == EqualizeMode::ADAPTIVE)
+        {
+            return ColorProcessing::adaptiveEqualizeHistogram(image, result, operation.params[1],
+                                                              static_cast<int>(operation.params[2]));
+        }
+        return ColorProcessing::equalizeHistogram(image, result);
+    }
+
+    // 辅助函数：执行单个空间滤波图层
+    bool ColorPipeline::applySpatial(const ColorOperation &operation, const cv::Mat &image, cv::Mat &result)
+    {
+        switch (operation.type)
+        {
+        case ColorOperationType::BLUR:
+            return SpatialFilters::boxBlur(image, result, static_cast<int>(operation.params[0]));
+        case ColorOperationType::GAUSSIAN_BLUR:
+            return SpatialFilters::gaussianBlur(image, result, operation.params[0]);
+        case ColorOperationType::UNSHARP_MASK:
+            return SpatialFilters::unsharpMask(image, result, operation.params[0], operation.params[1], operation.params[2]);
+        case ColorOperationType::SHARPEN:
+            return SpatialFilters::sharpen(image, result, operation.params[0]);
+        case ColorOperationType::GUIDED_FILTER:
+            return SpatialFilters::guidedFilter(image, result, static_cast<int>(operation.params[0]), operation.params[1]);
+        case ColorOperationType::DILATE:
+            return RankFilters::dilate(image, result, static_cast<int>(operation.params[0]));
+        case ColorOperationType::ERODE:
+            return RankFilters::erode(image, result, static_cast<int>(operation.params[0]));
+        case ColorOperationType::OPEN:
+            return RankFilters::open(image, result, static_cast<int>(operation.params[0]));
+        case ColorOperationType::CLOSE:
+            return RankFilters::close(image, result, static_cast<int>(operation.params[0]));
+        case ColorOperationType::MEDIAN:
+            return RankFilters::median(image, result, static_cast<int>(operation.params[0]));
+        case ColorOperationType::CONVOLVE:
+            return Convolution::filter(image, result, *operation.kernel, static_cast<ConvolutionMethod>(static_cast<int>(operation.params[0])));
+        case ColorOperationType::BINARIZE:
+            return Binarization::binarize(image, result, static_cast<BinarizeMode>(static_cast<int>(operation.params[0])),
+                                          operation.params[1], static_cast<int>(operation.params[2]), operation.params[3],
+                                          operation.params[4] != 0.0);
+        default:
+            return false;
+        }
+    }
+
+    // 辅助函数：由统计量把自动色阶/自动白平衡图层换算为逐通道线性变换图层
+    bool ColorPipeline::resolveAutoOperation(const ColorOperation &operation, const cv::Mat &image, ColorOperation &resolved)
+    {
+        cv::Vec3d alpha, beta;
+        bool ok = operation.type == ColorOperationType::AUTO_LEVELS
+                      ? ColorProcessing::computeAutoLevels(image, operation.params[0], static_cast<int>(operation.params[1]),
+                                                           alpha, beta)
+                      : ColorProcessing::computeWhiteBalance(image, static_cast<int>(operation.params[0]), alpha, beta);
+        if (!ok)
+        {
+            return false;
+        }
+
+        resolved = {ColorOperationType::CHANNEL_LINEAR, {alpha[0], alpha[1], alpha[2], beta[0], beta[1], beta[2]}};
+        return true;
+    }
+
+    bool ColorPipeline::applySequential(const cv::Mat &image, cv::Mat &result) const
+    {
+        // 各图层均原地写入 result，不再为每一层分配新图像
+        image.copyTo(result);
+        bool ok = true;
+        for (const auto &operation : operations_)
+        {
+            switch (operation.type)
+            {
+            case ColorOperationType::GRAYSCALE:
+                ok = ColorProcessing::convertToGrayscale(result, result);
+                break;
+            case ColorOperationType::GRAYSCALE_CUSTOM:
+                ok = ColorProcessing::convertToGrayscale(result, result, operation.params[0], operation.params[1], operation.params[2]);
+                break;
+            case ColorOperationType::BRIGHTNESS:
+                ok = ColorProcessing::adjustBrightness(result, result, static_cast<int>(operation.params[0]));
+                break;
+            case ColorOperationType::CONTRAST:
+                ok = ColorProcessing::adjustContrast(result, result, static_cast<int>(operation.params[0]));
+                break;
+            case ColorOperationType::SATURATION:
+                ok = ColorProcessing::adjustSaturation(result, result, static_cast<int>(operation.params[0]),
+                                                       static_cast<SaturationMode>(static_cast<int>(operation.params[1])));
+                break;
+            case ColorOperationType::INVERT:
+                ok = ColorProcessing::invertColors(result, result);
+                break;
+            case ColorOperationType::EQUALIZE:
+                ok = applyEqualize(operation, result, result);
+                break;
+            case ColorOperationType::BLUR:
+            case ColorOperationType::GAUSSIAN_BLUR:
+            case ColorOperationType::UNSHARP_MASK:
+            case ColorOperationType::SHARPEN:
+            case ColorOperationType::GUIDED_FILTER:
+            case ColorOperationType::DILATE:
+            case ColorOperationType::ERODE:
+            case ColorOperationType::OPEN:
+            case ColorOperationType::CLOSE:
+            case ColorOperationType::MEDIAN:
+            case ColorOperationType::CONVOLVE:
+            case ColorOperationType::BINARIZE:
+                ok = applySpatial(operation, result, result);
+                break;
+            case ColorOperationType::LUT3D:
+                ok = ColorProcessing::applyLut3D(result, result, *operation.lut);
+                break;
+            case ColorOperationType::CHANNEL_LINEAR:
+                ok = ColorProcessing::adjustChannels(result, result,
+                                                     cv::Vec3d(operation.params[0], operation.params[1], operation.params[2]),
+                                                     cv::Vec3d(operation.params[3], operation.params[4], operation.params[5]));
+                break;
+            case ColorOperationType::AUTO_LEVELS:
+                ok = ColorProcessing::autoLevels(result, result, operation.params[0], static_cast<int>(operation.params[1]));
+                break;
+            case ColorOperationType::AUTO_WHITE_BALANCE:
+                ok = ColorProcessing::autoWhiteBalance(result, result, static_cast<int>(operation.params[0]));
+                break;
+            }
+            if (!ok)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 辅助函数：按输入格式筛选出实际生效的图层，合并 8 位点运算，并推算输出通道数
+    bool ColorPipeline::compileStages(int depth, int input_channels, std::vector<Stage> &stages, int &output_channels,
+                                      bool report_skipped) const
+    {
+        int channels = input_channels;
+        // BGRA 图像灰度化后通道数不变，但颜色通道已经相同
+        bool gray = channels == 1;
+
+        // 线性光模式下 8 位图像在条带内以 16 位线性值处理
+        int working_depth = linear_light_ && depth == CV_8U ? CV_16U : depth;
+        auto push_transfer = [&](Transfer transfer, int transfer_depth)
+        {
+            Stage stage{ColorOperation{}, false, LookupTable(channels)};
+            stage.transfer = transfer;
+            stage.transfer_depth = transfer_depth;
+            stages.push_back(stage);
+        };
+        for (const auto &operation : operations_)
+        {
+            switch (operation.type)
+            {
+            case ColorOperationType::GRAYSCALE:
+            case ColorOperationType::GRAYSCALE_CUSTOM:
+                // 已经是灰度图像时，灰度化不产生任何变化
+                if (gray)
+                {
+                    continue;
+                }
+                if (operation.type == ColorOperationType::GRAYSCALE_CUSTOM &&
+                    operation.params[0] + operation.params[1] + operation.params[2] == 0)
+                {
+                    return false;
+                }
+                stages.push_back({operation, false, LookupTable(channels)});
+                gray = true;
+                if (channels == 3)
+                {
+                    channels = 1;
+                }
+                continue;
+            case ColorOperationType::SATURATION:
+                // 饱和度调整只对彩色图像生效
+                if (gray)
+                {
+                    if (report_skipped)
+                    {
+                        Logger::log(LogLevel::IP_LOGLV_WARNING, "Saturation adjustment requires a color image, layer skipped");
+                    }
+                    continue;
+                }
+                break;
+            case ColorOperationType::LUT3D:
+                // 查找表需要三个颜色通道；BGRA 灰度图像经过查找表后重新成为彩色图像
+                if (channels == 1)
+                {
+                    if (report_skipped)
+                    {
+                        Logger::log(LogLevel::IP_LOGLV_WARNING, "3D LUT requires a color image, layer skipped");
+                    }
+                    continue;
+                }
+                gray = false;
+
+                // 查找表按 sRGB 编码值制作，线性光模式下在条带内临时编码后查表再解码
+                if (linear_light_)
+                {
+                    push_transfer(Transfer::TO_SRGB, working_depth);
+                    stages.push_back({operation, false, LookupTable(channels)});
+                    push_transfer(Transfer::TO_LINEAR, working_depth);
+                    continue;
+                }
+                break;
+            case ColorOperationType::BRIGHTNESS:
+            case ColorOperationType::CONTRAST:
+            case ColorOperationType::INVERT:
+                // 16 位和浮点图像（以及线性光模式）的点运算逐个在条带上执行
+                if (working_depth != CV_8U)
+                {
+                    break;
+                }
+
+                // 点运算追加到上一张查找表中，没有则新建一张
+                if (stages.empty() || !stages.back().use_table)
+                {
+                    stages.push_back({operation, true, LookupTable(channels)});
+                }
+                // BGRA 图像只修改颜色通道的表项，Alpha 通道保持恒等映射
+                for (int c = 0; c < (channels == 4 ? 3 : 1); ++c)
+                {
+                    int channel = channels == 4 ? c : -1;
+                    if (operation.type == ColorOperationType::BRIGHTNESS)
+                    {
+                        stages.back().table.addBrightness(static_cast<int>(operation.params[0]), channel);
+                    }
+                    else if (operation.type == ColorOperationType::CONTRAST)
+                    {
+                        stages.back().table.addContrast(static_cast<int>(operation.params[0]), channel);
+                    }
+                    else
+                    {
+                        stages.back().table.addInvert(channel);
+                    }
+                }
+                continue;
+            case ColorOperationType::CHANNEL_LINEAR:
+                // 逐通道线性变换（自动色阶/白平衡的结果）按编码值统计，线性光模式下同样在编码值上执行
+                if (linear_light_)
+                {
+                    // 8 位图像在条带内以 16 位处理，偏移量按满量程换算
+                    ColorOperation scaled = operation;
+                    double scale = PixelKernels::maxValue(working_depth) / PixelKernels::maxValue(depth);
+                    for (int c = 3; c < 6; ++c)
+                    {
+                        scaled.params[c] *= scale;
+                    }
+                    push_transfer(Transfer::TO_SRGB, working_depth);
+                    stages.push_back({scaled, false, LookupTable(channels)});
+                    push_transfer(Transfer::TO_LINEAR, working_depth);
+                    continue;
+                }
+                if (working_depth != CV_8U)
+                {
+                    break;
+                }
+
+                // 8 位图像与相邻的点运算合并到同一张查找表中，只修改颜色通道的表项
+                if (stages.empty() || !stages.back().use_table)
+                {
+                    stages.push_back({operation, true, LookupTable(channels)});
+                }
+                for (int c = 0; c < (channels == 4 ? 3 : channels); ++c)
+                {
+                    stages.back().table.addBrightnessContrast(operation.params[c], operation.params[c + 3], c);
+                }
+                continue;
+            case ColorOperationType::EQUALIZE:
+            case ColorOperationType::AUTO_LEVELS:
+            case ColorOperationType::AUTO_WHITE_BALANCE:
+            case ColorOperationType::BLUR:
+            case ColorOperationType::GAUSSIAN_BLUR:
+            case ColorOperationType::UNSHARP_MASK:
+            case ColorOperationType::SHARPEN:
+            case ColorOperationType::GUIDED_FILTER:
+            case ColorOperationType::DILATE:
+            case ColorOperationType::ERODE:
+            case ColorOperationType::OPEN:
+            case ColorOperationType::CLOSE:
+            case ColorOperationType::MEDIAN:
+            case ColorOperationType::CONVOLVE:
+                // 屏障图层由 applySegments 在各段之间执行，这里只需推算通道数（这些图层不改变通道数）
+                continue;
+            case ColorOperationType::BINARIZE:
+                // 二值化输出单通道图像
+                channels = 1;
+                gray = true;
+                continue;
+            }
+            stages.push_back({operation, false, LookupTable(channels)});
+        }
+
+        // 线性光模式：第一个阶段解码为线性光，最后一个阶段编码回输入深度
+        // 图层栈以三维查找表开头时查找表直接读取输入，结尾时（深度不变）直接输出，省去相互抵消的编解码
+        if (linear_light_ && !stages.empty())
+        {
+            std::vector<Stage> body;
+            body.swap(stages);
+            auto begin = body.begin();
+            auto end = body.end();
+            if (begin->transfer == Transfer::TO_SRGB)
+            {
+                // 省去编码后，紧随其后的阶段直接读取输入深度的编码值：
+                // 逐通道线性变换的偏移量已按工作深度换算，需要换算回输入深度
+                ++begin;
+                if (begin != body.end() && begin->operation.type == ColorOperationType::CHANNEL_LINEAR && depth != working_depth)
+                {
+                    double scale = PixelKernels::maxValue(depth) / PixelKernels::maxValue(working_depth);
+                    for (int c = 3; c < 6; ++c)
+                    {
+                        begin->operation.params[c] *= scale;
+                    }
+                }
+            }
+            else
+            {
+                push_transfer(Transfer::TO_LINEAR, working_depth);
+            }
+
+            bool encode_output = !(body.back().transfer == Transfer::TO_LINEAR && depth == working_depth && end - begin > 1);
+            if (!encode_output)
+            {
+                --end;
+            }
+            stages.insert(stages.end(), begin, end);
+            if (encode_output)
+            {
+                push_transfer(Transfer::TO_SRGB, depth);
+            }
+        }
+
+        output_channels = channels;
+        return true;
+    }
+
+} // namespace image_processor
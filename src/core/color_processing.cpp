@@ -1,45 +1,180 @@
 #include <opencv2/imgproc.hpp>
+#include <opencv2/core.hpp>
 #include "color_processing.hpp"
+#include "color_kernels.hpp"
+#include "image_statistics.hpp"
+#include "lookup_table.hpp"
 #include "logger.hpp"
+#include "parallel.hpp"
+#include "pixel_kernels.hpp"
+#include <algorithm>
+#include <vector>
+#include <mutex>
+#include <type_traits>
 
 namespace image_processor
 {
 
+    namespace
+    {
+        // 在各行带上调用区域级内核；保留输入的引用，dst 与输入为同一图像时重新分配不会影响读取
+        template <typename Kernel>
+        void processBands(const cv::Mat &image, cv::Mat &dst, int dst_type, Kernel kernel)
+        {
+            cv::Mat input = image;
+            dst.create(input.rows, input.cols, dst_type);
+            Parallel::forEachRowBand(input, [&](const cv::Range &rows)
+                                     {
+                cv::Mat dst_rows = dst.rowRange(rows.start, rows.end);
+                kernel(input.rowRange(rows.start, rows.end), dst_rows); });
+        }
+
+        // 检查图像格式是否受支持，不支持时输出错误日志
+        bool checkFormat(const cv::Mat &image, const std::string &operation)
+        {
+            if (ColorKernels::isSupported(image))
+            {
+                return true;
+            }
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Unsupported image format for " + operation);
+            return false;
+        }
+
+        // 直方图的分箱：8 位和 16 位图像直接使用像素值，浮点图像量化为 16 位
+        inline int histogramBin(uchar value) { return value; }
+        inline int histogramBin(ushort value) { return value; }
+        inline int histogramBin(float value) { return cv::saturate_cast<ushort>(value * 65535.f); }
+
+        // 按 cv::equalizeHist 的规则由直方图生成均衡化映射（8 位时结果与其逐位一致）
+        void buildEqualizeTable(const std::vector<int> &hist, int total, std::vector<float> &table)
+        {
+            int bins = static_cast<int>(hist.size());
+            table.assign(bins, 0.f);
+            int i = 0;
+            while (!hist[i])
+            {
+                ++i;
+            }
+
+            // 只有一种灰度值时全部映射为该值
+            if (hist[i] == total)
+            {
+                std::fill(table.begin(), table.end(), static_cast<float>(i));
+                return;
+            }
+
+            float scale = (bins - 1.f) / (total - hist[i]);
+            int sum = 0;
+            for (table[i++] = 0; i < bins; ++i)
+            {
+                sum += hist[i];
+                table[i] = sum * scale;
+            }
+        }
+
+        // 统计第 0 个通道的直方图：各行带先统计局部直方图，最后合并
+        // BGRA 图像（CN 为 4）在各行带的局部缓冲区中转换到 YCrCb 后统计亮度
+        template <typename T, int CN>
+        void channelHistogram(const cv::Mat &image, std::vector<int> &hist)
+        {
+            constexpr int STRIDE = CN == 4 ? 3 : CN;
+            std::mutex merge_mutex;
+            Parallel::forEachRowBand(image, [&](const cv::Range &rows)
+                                     {
+                cv::Mat band = image.rowRange(rows.start, rows.end);
+                if (CN == 4)
+                {
+                    cv::Mat ycrcb;
+                    cv::cvtColor(band, ycrcb, cv::COLOR_BGR2YCrCb);
+                    band = ycrcb;
+                }
+
+                std::vector<int> local_hist(hist.size(), 0);
+                for (int i = 0; i < band.rows; ++i)
+                {
+                    const T *row = band.ptr<T>(i);
+                    for (int j = 0; j < band.cols; ++j)
+                    {
+                        ++local_hist[histogramBin(row[j * STRIDE])];
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(merge_mutex);
+                for (size_t k = 0; k < hist.size(); ++k)
+                {
+                    hist[k] += local_hist[k];
+                } });
+        }
+
+        // 把 YCrCb 缓冲区转换回 BGR 后写入 BGRA 图像的颜色通道，Alpha 通道取自 alpha_source
+        void storeBgraColor(cv::Mat &ycrcb, const cv::Mat &alpha_source, cv::Mat &dst)
+        {
+            cv::cvtColor(ycrcb, ycrcb, cv::COLOR_YCrCb2BGR);
+            const cv::Mat sources[] = {ycrcb, alpha_source};
+            const int from_to[] = {0, 0, 1, 1, 2, 2, 6, 3};
+            cv::mixChannels(sources, 2, &dst, 1, from_to, 4);
+        }
+    }
+
     cv::Mat ColorProcessing::convertToGrayscale(const cv::Mat &color_image)
+    {
+        cv::Mat grayscale_image;
+        return convertToGrayscale(color_image, grayscale_image) ? grayscale_image : cv::Mat();
+    }
+
+    bool ColorProcessing::convertToGrayscale(const cv::Mat &color_image, cv::Mat &dst)
     {
         if (color_image.empty())
         {
             Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot convert empty image to grayscale");
-            return cv::Mat();
+            return false;
         }
 
         // 检查图像是否已经是灰度图像
         if (color_image.channels() == 1)
         {
             Logger::log(LogLevel::IP_LOGLV_INFO, "Image is already grayscale");
-            return color_image.clone();
+            color_image.copyTo(dst);
+            return true;
         }
 
-        cv::Mat grayscale_image;
-        cv::cvtColor(color_image, grayscale_image, cv::COLOR_BGR2GRAY);
+        if (!checkFormat(color_image, "grayscale conversion"))
+        {
+            return false;
+        }
+
+        processBands(color_image, dst, ColorKernels::grayscaleType(color_image), [](const cv::Mat &src, cv::Mat &dst_rows)
+                     { ColorKernels::grayscale(src, dst_rows); });
 
         Logger::log(LogLevel::IP_LOGLV_INFO, "Image converted to grayscale successfully");
-        return grayscale_image;
+        return true;
     }
 
     cv::Mat ColorProcessing::convertToGrayscale(const cv::Mat &color_image, double weight_r, double weight_g, double weight_b)
+    {
+        cv::Mat grayscale_image;
+        return convertToGrayscale(color_image, grayscale_image, weight_r, weight_g, weight_b) ? grayscale_image : cv::Mat();
+    }
+
+    bool ColorProcessing::convertToGrayscale(const cv::Mat &color_image, cv::Mat &dst, double weight_r, double weight_g, double weight_b)
     {
         if (color_image.empty())
         {
             Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot convert empty image to grayscale");
-            return cv::Mat();
+            return false;
         }
 
         // 检查图像是否已经是灰度图像
         if (color_image.channels() == 1)
         {
             Logger::log(LogLevel::IP_LOGLV_INFO, "Image is already grayscale");
-            return color_image.clone();
+            color_image.copyTo(dst);
+            return true;
+        }
+
+        if (!checkFormat(color_image, "grayscale conversion"))
+        {
+            return false;
         }
 
         // 检查权重是否有效
@@ -47,7 +182,7 @@ namespace image_processor
         if (sum_weights == 0)
         {
             Logger::log(LogLevel::IP_LOGLV_ERROR, "Invalid weights for grayscale conversion: sum is zero");
-            return cv::Mat();
+            return false;
         }
 
         // 归一化权重
@@ -55,184 +190,545 @@ namespace image_processor
         weight_g /= sum_weights;
         weight_b /= sum_weights;
 
-        cv::Mat grayscale_image(color_image.rows, color_image.cols, CV_8UC1);
-
-        // 手动计算加权平均
-        for (int i = 0; i < color_image.rows; ++i)
-        {
-            for (int j = 0; j < color_image.cols; ++j)
-            {
-                cv::Vec3b pixel = color_image.at<cv::Vec3b>(i, j);
-                uchar blue = pixel[0];
-                uchar green = pixel[1];
-                uchar red = pixel[2];
-
-                // 使用加权平均计算灰度值
-                uchar gray_value = static_cast<uchar>(weight_r * red + weight_g * green + weight_b * blue);
-                grayscale_image.at<uchar>(i, j) = gray_value;
-            }
-        }
+        processBands(color_image, dst, ColorKernels::grayscaleType(color_image), [=](const cv::Mat &src, cv::Mat &dst_rows)
+                     { ColorKernels::grayscaleCustom(src, dst_rows, weight_r, weight_g, weight_b); });
 
         Logger::log(LogLevel::IP_LOGLV_INFO, "Image converted to grayscale with custom weights successfully");
-        return grayscale_image;
+        return true;
     }
 
     cv::Mat ColorProcessing::convertToColor(const cv::Mat &grayscale_image)
+    {
+        cv::Mat color_image;
+        return convertToColor(grayscale_image, color_image) ? color_image : cv::Mat();
+    }
+
+    bool ColorProcessing::convertToColor(const cv::Mat &grayscale_image, cv::Mat &dst)
     {
         if (grayscale_image.empty())
         {
             Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot convert empty grayscale image to color");
-            return cv::Mat();
+            return false;
         }
 
-        cv::Mat color_image;
-        cv::cvtColor(grayscale_image, color_image, cv::COLOR_GRAY2BGR);
+        processBands(grayscale_image, dst, CV_MAKETYPE(grayscale_image.depth(), 3), [](const cv::Mat &src, cv::Mat &dst_rows)
+                     { cv::cvtColor(src, dst_rows, cv::COLOR_GRAY2BGR); });
 
         Logger::log(LogLevel::IP_LOGLV_INFO, "Grayscale image converted to color successfully");
-        return color_image;
+        return true;
     }
 
     cv::Mat ColorProcessing::adjustBrightnessContrast(const cv::Mat &image, double alpha, double beta)
+    {
+        cv::Mat adjusted_image;
+        return adjustBrightnessContrast(image, adjusted_image, alpha, beta) ? adjusted_image : cv::Mat();
+    }
+
+    bool ColorProcessing::adjustBrightnessContrast(const cv::Mat &image, cv::Mat &dst, double alpha, double beta)
     {
         if (image.empty())
         {
             Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot adjust brightness/contrast of empty image");
-            return cv::Mat();
+            return false;
         }
 
-        cv::Mat adjusted_image;
-        image.convertTo(adjusted_image, -1, alpha, beta);
+        if (!checkFormat(image, "brightness/contrast adjustment"))
+        {
+            return false;
+        }
+
+        processBands(image, dst, image.type(), [=](const cv::Mat &src, cv::Mat &dst_rows)
+                     { ColorKernels::brightnessContrast(src, dst_rows, alpha, beta); });
 
         Logger::log(LogLevel::IP_LOGLV_INFO, "Brightness and contrast adjusted successfully");
-        return adjusted_image;
+        return true;
     }
 
     cv::Mat ColorProcessing::adjustBrightness(const cv::Mat &image, int brightness)
+    {
+        cv::Mat adjusted_image;
+        return adjustBrightness(image, adjusted_image, brightness) ? adjusted_image : cv::Mat();
+    }
+
+    bool ColorProcessing::adjustBrightness(const cv::Mat &image, cv::Mat &dst, int brightness)
     {
         if (image.empty())
         {
             Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot adjust brightness of empty image");
-            return cv::Mat();
+            return false;
         }
 
-        // 将亮度值从 [-100, 100] 转换为 [0, 200] 的范围，然后转换为 [0, 2.0] 的倍数
-        double beta = brightness * 2.0;
+        if (!checkFormat(image, "brightness adjustment"))
+        {
+            return false;
+        }
 
-        cv::Mat adjusted_image;
-        image.convertTo(adjusted_image, -1, 1.0, beta);
+        // 将亮度值从 [-100, 100] 转换为 [-200, 200] 的偏移量（以 8 位为单位，按图像深度换算到满量程）
+        double beta = brightness * 2.0 * PixelKernels::maxValue(image.depth()) / 255.0;
+        processBands(image, dst, image.type(), [=](const cv::Mat &src, cv::Mat &dst_rows)
+                     { ColorKernels::brightnessContrast(src, dst_rows, 1.0, beta); });
 
         Logger::log(LogLevel::IP_LOGLV_INFO, "Brightness adjusted successfully");
-        return adjusted_image;
+        return true;
     }
 
     cv::Mat ColorProcessing::adjustContrast(const cv::Mat &image, int contrast)
+    {
+        cv::Mat adjusted_image;
+        return adjustContrast(image, adjusted_image, contrast) ? adjusted_image : cv::Mat();
+    }
+
+    bool ColorProcessing::adjustContrast(const cv::Mat &image, cv::Mat &dst, int contrast)
     {
         if (image.empty())
         {
             Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot adjust contrast of empty image");
-            return cv::Mat();
+            return false;
+        }
+
+        if (!checkFormat(image, "contrast adjustment"))
+        {
+            return false;
         }
 
         // 将对比度值从 [-100, 100] 转换为 [0, 200] 的范围，然后转换为 [0, 2.0] 的倍数
         double alpha = (contrast + 100.0) / 100.0;
-
-        cv::Mat adjusted_image;
-        image.convertTo(adjusted_image, -1, alpha, 0.0);
+        processBands(image, dst, image.type(), [=](const cv::Mat &src, cv::Mat &dst_rows)
+                     { ColorKernels::brightnessContrast(src, dst_rows, alpha, 0.0); });
 
         Logger::log(LogLevel::IP_LOGLV_INFO, "Contrast adjusted successfully");
-        return adjusted_image;
+        return true;
+    }
+
+    cv::Mat ColorProcessing::adjustSaturation(const cv::Mat &image, int saturation, SaturationMode mode)
+    {
+        cv::Mat result_image;
+        return adjustSaturation(image, result_image, saturation, mode) ? result_image : cv::Mat();
     }
 
-    cv::Mat ColorProcessing::adjustSaturation(const cv::Mat &image, int saturation)
+    bool ColorProcessing::adjustSaturation(const cv::Mat &image, cv::Mat &dst, int saturation, SaturationMode mode)
     {
         if (image.empty())
         {
             Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot adjust saturation of empty image");
-            return cv::Mat();
+            return false;
         }
 
         // 检查图像是否是彩色图像
-        if (image.channels() != 3)
+        if (image.channels() != 3 && image.channels() != 4)
         {
             Logger::log(LogLevel::IP_LOGLV_ERROR, "Saturation adjustment requires a color image");
-            return image.clone();
+            image.copyTo(dst);
+            return true;
         }
 
-        cv::Mat hsv_image;
-        cv::cvtColor(image, hsv_image, cv::COLOR_BGR2HSV);
-
-        // 将饱和度值从 [-100, 100] 转换为调整因子
-        double factor = (saturation + 100.0) / 100.0;
+        if (!checkFormat(image, "saturation adjustment"))
+        {
+            return false;
+        }
 
-        // 调整饱和度通道
-        for (int i = 0; i < hsv_image.rows; ++i)
+        // HSV 算法只支持 8 位和浮点 BGR 图像，其余格式改用亮度插值
+        if (mode == SaturationMode::HSV &&
+            (image.channels() != 3 || (image.depth() != CV_8U && image.depth() != CV_32F)))
         {
-            for (int j = 0; j < hsv_image.cols; ++j)
-            {
-                cv::Vec3b pixel = hsv_image.at<cv::Vec3b>(i, j);
-                // 像素[1]是饱和度通道 (0-255)
-                double new_saturation = pixel[1] * factor;
-                // 确保值在0-255范围内
-                pixel[1] = static_cast<uchar>(std::min(255.0, std::max(0.0, new_saturation)));
-                hsv_image.at<cv::Vec3b>(i, j) = pixel;
-            }
+            Logger::log(LogLevel::IP_LOGLV_WARNING, "HSV saturation requires an 8-bit or float BGR image, using luma mode");
+            mode = SaturationMode::LUMA;
         }
 
-        cv::Mat result_image;
-        cv::cvtColor(hsv_image, result_image, cv::COLOR_HSV2BGR);
+        // 将饱和度值从 [-100, 100] 转换为调整因子
+        double factor = (saturation + 100.0) / 100.0;
+        processBands(image, dst, image.type(), [=](const cv::Mat &src, cv::Mat &dst_rows)
+                     {
+            cv::Mat hsv_image;
+            ColorKernels::saturation(src, dst_rows, factor, mode, hsv_image); });
 
         Logger::log(LogLevel::IP_LOGLV_INFO, "Image saturation adjusted successfully");
-        return result_image;
+        return true;
     }
 
     cv::Mat ColorProcessing::equalizeHistogram(const cv::Mat &image)
+    {
+        cv::Mat equalized_image;
+        return equalizeHistogram(image, equalized_image) ? equalized_image : cv::Mat();
+    }
+
+    bool ColorProcessing::equalizeHistogram(const cv::Mat &image, cv::Mat &dst)
     {
         if (image.empty())
         {
             Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot equalize histogram of empty image");
-            return cv::Mat();
+            return false;
         }
 
-        cv::Mat equalized_image;
-        if (image.channels() == 1)
+        if (!checkFormat(image, "histogram equalization"))
         {
-            // 灰度图像直方图均衡化
-            cv::equalizeHist(image, equalized_image);
+            return false;
         }
-        else
+
+        // BGR 图像先把 YCrCb 结果写入 dst，之后原地映射亮度通道并转换回 BGR
+        // （此后不再读取输入，dst 可以与输入为同一图像）
+        // BGRA 图像在各行带的局部缓冲区中转换和映射，只写回颜色通道，Alpha 通道保持不变
+        cv::Mat input = image;
+        dst.create(input.rows, input.cols, input.type());
+        if (input.channels() == 3)
         {
-            // 彩色图像直方图均衡化
-            cv::Mat ycrcb_image;
-            cv::cvtColor(image, ycrcb_image, cv::COLOR_BGR2YCrCb);
+            Parallel::forEachRowBand(input, [&](const cv::Range &rows)
+                                     {
+                cv::Mat dst_rows = dst.rowRange(rows.start, rows.end);
+                cv::cvtColor(input.rowRange(rows.start, rows.end), dst_rows, cv::COLOR_BGR2YCrCb); });
+        }
+        const cv::Mat &luma_source = input.channels() == 3 ? dst : input;
+
+        PixelKernels::dispatch(input.depth(), input.channels(), [&](auto format)
+                               {
+            typedef typename decltype(format)::value_type T;
+            constexpr int CN = decltype(format)::channels;
+
+            // 8 位图像使用 256 个分箱，16 位和浮点图像使用 65536 个分箱
+            std::vector<int> hist(std::is_same<T, uchar>::value ? 256 : 65536, 0);
+            channelHistogram<T, CN>(luma_source, hist);
 
-            std::vector<cv::Mat> channels;
-            cv::split(ycrcb_image, channels);
+            std::vector<float> table;
+            buildEqualizeTable(hist, static_cast<int>(input.total()), table);
+
+            // 把映射换算为像素类型的查找表（浮点图像映射回 [0, 1]）
+            std::vector<T> mapping(table.size());
+            for (size_t k = 0; k < table.size(); ++k)
+            {
+                mapping[k] = std::is_same<T, float>::value ? static_cast<T>(table[k] / 65535.f)
+                                                           : cv::saturate_cast<T>(table[k]);
+            }
 
             // 仅对亮度通道进行均衡化
-            cv::equalizeHist(channels[0], channels[0]);
+            auto map_luma = [&mapping](const T *src_pixel, T *dst_pixel)
+            { dst_pixel[0] = mapping[histogramBin(src_pixel[0])]; };
+            Parallel::forEachRowBand(luma_source, [&](const cv::Range &rows)
+                                     {
+                cv::Mat dst_rows = dst.rowRange(rows.start, rows.end);
+                if (CN == 4)
+                {
+                    cv::Mat input_rows = input.rowRange(rows.start, rows.end);
+                    cv::Mat ycrcb;
+                    cv::cvtColor(input_rows, ycrcb, cv::COLOR_BGR2YCrCb);
+                    PixelKernels::transformRows<T, 3, 3>(ycrcb, ycrcb, cv::Range(0, ycrcb.rows), map_luma);
+                    storeBgraColor(ycrcb, input_rows, dst_rows);
+                    return;
+                }
+
+                PixelKernels::transformRows<T, CN, CN>(luma_source, dst, rows, map_luma);
+                if (CN == 3)
+                {
+                    cv::cvtColor(dst_rows, dst_rows, cv::COLOR_YCrCb2BGR);
+                } }); });
+
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Image histogram equalized successfully");
+        return true;
+    }
+
+    cv::Mat ColorProcessing::adaptiveEqualizeHistogram(const cv::Mat &image, double clip_limit, int tile_grid)
+    {
+        cv::Mat equalized_image;
+        return adaptiveEqualizeHistogram(image, equalized_image, clip_limit, tile_grid) ? equalized_image : cv::Mat();
+    }
+
+    bool ColorProcessing::adaptiveEqualizeHistogram(const cv::Mat &image, cv::Mat &dst, double clip_limit, int tile_grid)
+    {
+        if (image.empty())
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot equalize histogram of empty image");
+            return false;
+        }
 
-            // 合并通道
-            cv::merge(channels, ycrcb_image);
-            cv::cvtColor(ycrcb_image, equalized_image, cv::COLOR_YCrCb2BGR);
+        if (!checkFormat(image, "adaptive histogram equalization"))
+        {
+            return false;
         }
 
-        Logger::log(LogLevel::IP_LOGLV_INFO, "Image histogram equalized successfully");
-        return equalized_image;
+        if (tile_grid < 1 || tile_grid > MAX_TILE_GRID || clip_limit < 0)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Invalid tile grid or clip limit for adaptive equalization");
+            return false;
+        }
+
+        // OpenCV 的 CLAHE 在共享线程池上并行计算各分块的查找表，并按行并行完成双线性插值
+        // CLAHE 只支持 8 位和 16 位图像，浮点图像的亮度通道量化为 16 位后处理
+        cv::Ptr<cv::CLAHE> clahe = cv::createCLAHE(clip_limit, cv::Size(tile_grid, tile_grid));
+        cv::Mat input = image;
+        bool is_float = input.depth() == CV_32F;
+        int luma_type = is_float ? CV_16UC1 : CV_MAKETYPE(input.depth(), 1);
+
+        if (input.channels() == 1 && !is_float)
+        {
+            clahe->apply(input, dst);
+        }
+        else
+        {
+            // 亮度通道的提取、量化和写回均按行带并行
+            // BGRA 图像的 YCrCb 结果只保存在各行带的局部缓冲区中，写回时重新转换，Alpha 通道保持不变
+            cv::Mat luma(input.rows, input.cols, luma_type);
+            dst.create(input.rows, input.cols, input.type());
+            Parallel::forEachRowBand(input, [&](const cv::Range &rows)
+                                     {
+                cv::Mat dst_rows = dst.rowRange(rows.start, rows.end);
+                cv::Mat luma_rows = luma.rowRange(rows.start, rows.end);
+                cv::Mat channel;
+                if (input.channels() == 3)
+                {
+                    cv::cvtColor(input.rowRange(rows.start, rows.end), dst_rows, cv::COLOR_BGR2YCrCb);
+                    cv::extractChannel(dst_rows, channel, 0);
+                }
+                else if (input.channels() == 4)
+                {
+                    cv::Mat ycrcb;
+                    cv::cvtColor(input.rowRange(rows.start, rows.end), ycrcb, cv::COLOR_BGR2YCrCb);
+                    cv::extractChannel(ycrcb, channel, 0);
+                }
+                else
+                {
+                    channel = input.rowRange(rows.start, rows.end);
+                }
+                channel.convertTo(luma_rows, luma_type, is_float ? 65535.0 : 1.0); });
+
+            clahe->apply(luma, luma);
+
+            Parallel::forEachRowBand(dst, [&](const cv::Range &rows)
+                                     {
+                cv::Mat dst_rows = dst.rowRange(rows.start, rows.end);
+                cv::Mat channel;
+                luma.rowRange(rows.start, rows.end).convertTo(channel, input.depth(), is_float ? 1.0 / 65535.0 : 1.0);
+                if (input.channels() == 3)
+                {
+                    cv::insertChannel(channel, dst_rows, 0);
+                    cv::cvtColor(dst_rows, dst_rows, cv::COLOR_YCrCb2BGR);
+                }
+                else if (input.channels() == 4)
+                {
+                    cv::Mat input_rows = input.rowRange(rows.start, rows.end);
+                    cv::Mat ycrcb;
+                    cv::cvtColor(input_rows, ycrcb, cv::COLOR_BGR2YCrCb);
+                    cv::insertChannel(channel, ycrcb, 0);
+                    storeBgraColor(ycrcb, input_rows, dst_rows);
+                }
+                else
+                {
+                    channel.copyTo(dst_rows);
+                } });
+        }
+
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Adaptive histogram equalization applied successfully");
+        return true;
     }
 
     cv::Mat ColorProcessing::invertColors(const cv::Mat &image)
+    {
+        cv::Mat inverted_image;
+        return invertColors(image, inverted_image) ? inverted_image : cv::Mat();
+    }
+
+    bool ColorProcessing::invertColors(const cv::Mat &image, cv::Mat &dst)
     {
         if (image.empty())
         {
             Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot invert colors of empty image");
-            return cv::Mat();
+            return false;
         }
 
-        cv::Mat inverted_image;
-        cv::bitwise_not(image, inverted_image);
+        if (!checkFormat(image, "color inversion"))
+        {
+            return false;
+        }
+
+        processBands(image, dst, image.type(), [](const cv::Mat &src, cv::Mat &dst_rows)
+                     { ColorKernels::invert(src, dst_rows); });
 
         Logger::log(LogLevel::IP_LOGLV_INFO, "Colors inverted successfully");
-        return inverted_image;
+        return true;
+    }
+
+    cv::Mat ColorProcessing::adjustChannels(const cv::Mat &image, const cv::Vec3d &alpha, const cv::Vec3d &beta)
+    {
+        cv::Mat adjusted_image;
+        return adjustChannels(image, adjusted_image, alpha, beta) ? adjusted_image : cv::Mat();
+    }
+
+    bool ColorProcessing::adjustChannels(const cv::Mat &image, cv::Mat &dst, const cv::Vec3d &alpha, const cv::Vec3d &beta)
+    {
+        if (image.empty())
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot adjust channels of empty image");
+            return false;
+        }
+
+        if (!checkFormat(image, "channel adjustment"))
+        {
+            return false;
+        }
+
+        if (image.depth() == CV_8U)
+        {
+            // 8 位图像合并为每通道一张查找表（BGRA 的 Alpha 通道保持恒等映射）
+            LookupTable table(image.channels());
+            int color_channels = image.channels() == 4 ? 3 : image.channels();
+            for (int c = 0; c < color_channels; ++c)
+            {
+                table.addBrightnessContrast(alpha[c], beta[c], c);
+            }
+            processBands(image, dst, image.type(), [&table](const cv::Mat &src, cv::Mat &dst_rows)
+                         { table.apply(src, dst_rows); });
+        }
+        else
+        {
+            processBands(image, dst, image.type(), [&](const cv::Mat &src, cv::Mat &dst_rows)
+                         { ColorKernels::channelLinear(src, dst_rows, alpha, beta); });
+        }
+
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Channels adjusted successfully");
+        return true;
+    }
+
+    bool ColorProcessing::computeAutoLevels(const cv::Mat &image, double clip_percent, int sample_step,
+                                            cv::Vec3d &alpha, cv::Vec3d &beta)
+    {
+        if (clip_percent < 0 || clip_percent >= 50)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Auto levels clip percent must be in [0, 50)");
+            return false;
+        }
+
+        ImageStats stats;
+        int step = sample_step == 0 ? ImageStatistics::autoSampleStep(image) : sample_step;
+        if (!ImageStatistics::compute(image, stats, {clip_percent, 100.0 - clip_percent}, step))
+        {
+            return false;
+        }
+
+        alpha = cv::Vec3d(1.0, 1.0, 1.0);
+        beta = cv::Vec3d(0.0, 0.0, 0.0);
+        int color_channels = std::min(3, image.channels());
+        for (int c = 0; c < color_channels; ++c)
+        {
+            // 裁剪点重合（例如纯色通道）时保持不变
+            double low = stats.channels[c].percentiles[0];
+            double high = stats.channels[c].percentiles[1];
+            if (high > low)
+            {
+                alpha[c] = stats.max_value / (high - low);
+                beta[c] = -low * alpha[c];
+            }
+        }
+        return true;
+    }
+
+    bool ColorProcessing::computeWhiteBalance(const cv::Mat &image, int sample_step, cv::Vec3d &alpha, cv::Vec3d &beta)
+    {
+        alpha = cv::Vec3d(1.0, 1.0, 1.0);
+        beta = cv::Vec3d(0.0, 0.0, 0.0);
+        if (image.channels() == 1)
+        {
+            return true;
+        }
+
+        ImageStats stats;
+        int step = sample_step == 0 ? ImageStatistics::autoSampleStep(image) : sample_step;
+        if (!ImageStatistics::compute(image, stats, {}, step))
+        {
+            return false;
+        }
+
+        double gray = (stats.channels[0].mean + stats.channels[1].mean + stats.channels[2].mean) / 3.0;
+        for (int c = 0; c < 3; ++c)
+        {
+            if (stats.channels[c].mean > 0)
+            {
+                alpha[c] = gray / stats.channels[c].mean;
+            }
+        }
+        return true;
+    }
+
+    cv::Mat ColorProcessing::autoLevels(const cv::Mat &image, double clip_percent, int sample_step)
+    {
+        cv::Mat leveled_image;
+        return autoLevels(image, leveled_image, clip_percent, sample_step) ? leveled_image : cv::Mat();
+    }
+
+    bool ColorProcessing::autoLevels(const cv::Mat &image, cv::Mat &dst, double clip_percent, int sample_step)
+    {
+        if (image.empty())
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot apply auto levels to empty image");
+            return false;
+        }
+
+        // 一次统计遍历加一次查表遍历
+        cv::Vec3d alpha, beta;
+        if (!computeAutoLevels(image, clip_percent, sample_step, alpha, beta))
+        {
+            return false;
+        }
+        return adjustChannels(image, dst, alpha, beta);
+    }
+
+    cv::Mat ColorProcessing::autoWhiteBalance(const cv::Mat &image, int sample_step)
+    {
+        cv::Mat balanced_image;
+        return autoWhiteBalance(image, balanced_image, sample_step) ? balanced_image : cv::Mat();
+    }
+
+    bool ColorProcessing::autoWhiteBalance(const cv::Mat &image, cv::Mat &dst, int sample_step)
+    {
+        if (image.empty())
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot apply auto white balance to empty image");
+            return false;
+        }
+
+        if (image.channels() == 1)
+        {
+            Logger::log(LogLevel::IP_LOGLV_WARNING, "Auto white balance requires a color image");
+            image.copyTo(dst);
+            return true;
+        }
+
+        // 一次统计遍历加一次查表遍历
+        cv::Vec3d alpha, beta;
+        if (!computeWhiteBalance(image, sample_step, alpha, beta))
+        {
+            return false;
+        }
+        return adjustChannels(image, dst, alpha, beta);
+    }
+
+    cv::Mat ColorProcessing::applyLut3D(const cv::Mat &image, const ColorLut3D &lut)
+    {
+        cv::Mat graded_image;
+        return applyLut3D(image, graded_image, lut) ? graded_image : cv::Mat();
+    }
+
+    bool ColorProcessing::applyLut3D(const cv::Mat &image, cv::Mat &dst, const ColorLut3D &lut)
+    {
+        if (image.empty())
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot apply 3D LUT to empty image");
+            return false;
+        }
+
+        if (image.channels() != 3 && image.channels() != 4)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "3D LUT requires a color image");
+            return false;
+        }
+
+        if (!checkFormat(image, "3D LUT"))
+        {
+            return false;
+        }
+
+        processBands(image, dst, image.type(), [&lut](const cv::Mat &src, cv::Mat &dst_rows)
+                     { ColorKernels::lut3D(src, dst_rows, lut); });
+
+        Logger::log(LogLevel::IP_LOGLV_INFO, "3D LUT applied successfully");
+        return true;
     }
 
-} // namespace image_processor
\ No newline at end of file
+} // namespace image_processor
@@ -4,7 +4,11 @@
 #include <vector>
 #include <map>
 #include "logger.hpp"
+#include "parallel.hpp"
+#include "pixel_kernels.hpp"
 #include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <iterator>
 
 namespace image_processor
 {
@@ -19,41 +23,57 @@ namespace image_processor
             return triplets;
         }
 
-        // 使用原始图像，不强制转换为灰度图
-        cv::Mat processed_image = image.clone();
-
-        // 将图像转换为三元组（只存储非零像素以节省空间）
-        for (int i = 0; i < processed_image.rows; ++i)
+        // 三元组只能保存 8 位像素值
+        if (image.depth() != CV_8U)
         {
-            for (int j = 0; j < processed_image.cols; ++j)
-            {
-                // 检查是否所有通道都是零值
-                bool isAllZero = true;
-                std::vector<uchar> pixel_values(processed_image.channels());
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Triplet conversion requires an 8-bit image");
+            return triplets;
+        }
 
-                for (int c = 0; c < processed_image.channels(); ++c)
+        // 将图像转换为三元组（只存储非零像素以节省空间）
+        // 各行独立收集后按行号顺序拼接，保证输出顺序与逐行扫描一致
+        std::vector<std::vector<PixelTriplet>> row_triplets(image.rows);
+        bool supported = PixelKernels::dispatchChannels<uchar>(image.channels(), [&](auto format)
+                                                                {
+            constexpr int CN = decltype(format)::channels;
+            Parallel::forEachRowBand(image, [&](const cv::Range &rows)
+                                     {
+                for (int i = rows.start; i < rows.end; ++i)
                 {
-                    if (processed_image.channels() == 1)
-                    {
-                        pixel_values[c] = processed_image.at<uchar>(i, j);
-                    }
-                    else
+                    const uchar *row = image.ptr<uchar>(i);
+                    for (int j = 0; j < image.cols; ++j)
                     {
-                        pixel_values[c] = processed_image.at<cv::Vec3b>(i, j)[c];
+                        const uchar *pixel = row + j * CN;
+
+                        // 检查是否所有通道都是零值
+                        bool isAllZero = true;
+                        for (int c = 0; c < CN; ++c)
+                        {
+                            isAllZero = isAllZero && pixel[c] == 0;
+                        }
+
+                        // 只存储非零像素
+                        if (!isAllZero)
+                        {
+                            row_triplets[i].push_back({i, j, std::vector<uchar>(pixel, pixel + CN)});
+                        }
                     }
+                } }); });
+        if (!supported)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Unsupported channel count for triplet conversion");
+            return triplets;
+        }
 
-                    if (pixel_values[c] != 0)
-                    {
-                        isAllZero = false;
-                    }
-                }
-
-                // 只存储非零像素
-                if (!isAllZero)
-                {
-                    triplets.push_back({i, j, pixel_values});
-                }
-            }
+        size_t total = 0;
+        for (const auto &row : row_triplets)
+        {
+            total += row.size();
+        }
+        triplets.reserve(total);
+        for (auto &row : row_triplets)
+        {
+            std::move(row.begin(), row.end(), std::back_inserter(triplets));
         }
 
         Logger::log(LogLevel::IP_LOGLV_INFO, "Image converted to triplets successfully");
@@ -68,33 +88,19 @@ namespace image_processor
             return cv::Mat();
         }
 
-        // 创建空图像（初始化为黑色）
-        cv::Mat image;
-        if (channels == 1)
-        {
-            image = cv::Mat(rows, cols, CV_8UC1, cv::Scalar(0));
-        }
-        else
-        {
-            image = cv::Mat(rows, cols, CV_8UC3, cv::Scalar(0, 0, 0));
-        }
+        // 创建空图像（初始化为黑色）：单通道和 BGRA 图像保持通道数（Alpha 通道随三元组恢复），其余通道数按 3 通道彩色图像处理
+        int image_channels = channels == 1 || channels == 4 ? channels : 3;
+        cv::Mat image(rows, cols, CV_8UC(image_channels), cv::Scalar::all(0));
 
         // 将三元组数据填充到图像中
         for (const auto &triplet : triplets)
         {
             if (triplet.row >= 0 && triplet.row < rows && triplet.col >= 0 && triplet.col < cols)
             {
-                if (channels == 1)
+                uchar *pixel = image.ptr<uchar>(triplet.row) + triplet.col * image_channels;
+                for (int c = 0; c < std::min(image_channels, static_cast<int>(triplet.values.size())); ++c)
                 {
-                    image.at<uchar>(triplet.row, triplet.col) = triplet.values[0];
-                }
-                else
-                {
-                    cv::Vec3b &pixel = image.at<cv::Vec3b>(triplet.row, triplet.col);
-                    for (int c = 0; c < std::min(3, (int)triplet.values.size()); ++c)
-                    {
-                        pixel[c] = triplet.values[c];
-                    }
+                    pixel[c] = triplet.values[c];
                 }
             }
         }
@@ -0,0 +1,305 @@
+#include "convolution.hpp"
+#include "logger.hpp"
+#include "parallel.hpp"
+#include "pixel_kernels.hpp"
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace image_processor
+{
+
+    namespace
+    {
+        // 面积不超过该值的卷积核直接卷积（11x11），更大的卷积核改用频域卷积
+        const int MAX_DIRECT_AREA = 121;
+
+        // 第二奇异值与第一奇异值之比低于该值时视为秩为 1
+        const double SEPARABLE_TOLERANCE = 1e-6;
+
+        // 频域分块边长约为卷积核边长的 4 倍（有效输出约占分块的 3/4），但不小于 256
+        const int FFT_TILE_FACTOR = 4;
+        const int MIN_FFT_TILE = 256;
+
+        // 缓存的卷积核频谱数量上限，超出时淘汰最早加入的频谱
+        const size_t MAX_CACHED_SPECTRA = 16;
+
+        std::mutex cache_mutex;
+        std::unordered_map<uint64_t, std::shared_ptr<const cv::Mat>> cache;
+        std::deque<uint64_t> cache_order;
+
+        // 64 位 FNV-1a 哈希：卷积核的值、尺寸和分块尺寸都参与计算
+        uint64_t spectrumKey(const cv::Mat &kernel, int tile_rows, int tile_cols)
+        {
+            uint64_t hash = 14695981039346656037ULL;
+            auto mix = [&hash](const unsigned char *bytes, size_t size)
+            {
+                for (size_t i = 0; i < size; ++i)
+                {
+                    hash ^= bytes[i];
+                    hash *= 1099511628211ULL;
+                }
+            };
+            int dims[4] = {kernel.rows, kernel.cols, tile_rows, tile_cols};
+            mix(reinterpret_cast<const unsigned char *>(dims), sizeof(dims));
+            for (int i = 0; i < kernel.rows; ++i)
+            {
+                mix(kernel.ptr<uchar>(i), kernel.cols * sizeof(double));
+            }
+            return hash;
+        }
+
+        // 取得翻转后卷积核在 tile_rows x tile_cols 分块上的频谱（CCS 压缩格式），
+        // 与分块频谱相乘即得到按相关运算计算的循环卷积
+        std::shared_ptr<const cv::Mat> kernelSpectrum(const cv::Mat &kernel, int tile_rows, int tile_cols)
+        {
+            uint64_t key = spectrumKey(kernel, tile_rows, tile_cols);
+            {
+                std::lock_guard<std::mutex> lock(cache_mutex);
+                auto it = cache.find(key);
+                if (it != cache.end())
+                {
+                    Logger::log(LogLevel::IP_LOGLV_DEBUG, "Convolution kernel spectrum found in cache");
+                    return it->second;
+                }
+            }
+
+            // 在锁外计算，避免阻塞其他请求
+            auto spectrum = std::make_shared<cv::Mat>(tile_rows, tile_cols, CV_32F, cv::Scalar(0));
+            cv::Mat flipped;
+            cv::flip(kernel, flipped, -1);
+            cv::Mat corner = (*spectrum)(cv::Rect(0, 0, kernel.cols, kernel.rows));
+            flipped.convertTo(corner, CV_32F);
+            cv::dft(*spectrum, *spectrum, 0, kernel.rows);
+
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            if (cache.emplace(key, spectrum).second)
+            {
+                cache_order.push_back(key);
+                if (cache_order.size() > MAX_CACHED_SPECTRA)
+                {
+                    cache.erase(cache_order.front());
+                    cache_order.pop_front();
+                }
+            }
+            return spectrum;
+        }
+
+        // 把卷积核分解为列向量和行向量（秩不为 1 时返回 false）
+        bool separateKernel(const cv::Mat &kernel, cv::Mat &column, cv::Mat &row)
+        {
+            if (kernel.rows == 1 || kernel.cols == 1)
+            {
+                column = kernel.rows == 1 ? cv::Mat(1, 1, CV_64F, cv::Scalar(1)) : kernel;
+                row = kernel.rows == 1 ? kernel : cv::Mat(1, 1, CV_64F, cv::Scalar(1));
+                return true;
+            }
+
+            cv::Mat w, u, vt;
+            cv::SVD::compute(kernel, w, u, vt);
+            double first = w.at<double>(0, 0);
+            if (first <= 0.0 || w.at<double>(1, 0) > first * SEPARABLE_TOLERANCE)
+            {
+                return false;
+            }
+            column = u.col(0) * std::sqrt(first);
+            row = vt.row(0) * std::sqrt(first);
+            return true;
+        }
+
+        // 频域卷积的一个分块：按边缘复制取出输入，逐通道正变换、与卷积核频谱相乘、逆变换，
+        // 循环卷积中不受回绕影响的右下部分即为该分块的输出
+        template <typename T, int CN>
+        void convolveTile(const cv::Mat &src, cv::Mat &dst, const cv::Mat &spectrum, const cv::Size &kernel_size,
+                          int y0, int x0, cv::Mat &plane, std::vector<int> &columns)
+        {
+            int tile_rows = spectrum.rows;
+            int tile_cols = spectrum.cols;
+            int top = y0 - kernel_size.height / 2;
+            int left = x0 - kernel_size.width / 2;
+            int out_rows = std::min(tile_rows - kernel_size.height + 1, src.rows - y0);
+            int out_cols = std::min(tile_cols - kernel_size.width + 1, src.cols - x0);
+
+            columns.resize(tile_cols);
+            for (int j = 0; j < tile_cols; ++j)
+            {
+                columns[j] = std::min(std::max(left + j, 0), src.cols - 1) * CN;
+            }
+
+            for (int c = 0; c < CN; ++c)
+            {
+                for (int i = 0; i < tile_rows; ++i)
+                {
+                    const T *in = src.ptr<T>(std::min(std::max(top + i, 0), src.rows - 1)) + c;
+                    float *values = plane.ptr<float>(i);
+                    for (int j = 0; j < tile_cols; ++j)
+                    {
+                        values[j] = static_cast<float>(in[columns[j]]);
+                    }
+                }
+
+                cv::dft(plane, plane);
+                cv::mulSpectrums(plane, spectrum, plane, 0);
+                cv::dft(plane, plane, cv::DFT_INVERSE | cv::DFT_SCALE | cv::DFT_REAL_OUTPUT);
+
+                for (int i = 0; i < out_rows; ++i)
+                {
+                    const float *values = plane.ptr<float>(i + kernel_size.height - 1) + kernel_size.width - 1;
+                    T *out = dst.ptr<T>(y0 + i) + x0 * CN + c;
+                    for (int j = 0; j < out_cols; ++j)
+                    {
+                        out[j * CN] = cv::saturate_cast<T>(values[j]);
+                    }
+                }
+            }
+        }
+
+        // 频域卷积：图像切分为输出互不重叠的分块并行处理，每个分块的变换尺寸相同，共用一份卷积核频谱
+        void convolveFFT(const cv::Mat &image, cv::Mat &dst, const cv::Mat &kernel)
+        {
+            int tile_rows = cv::getOptimalDFTSize(std::min(std::max(FFT_TILE_FACTOR * kernel.rows, MIN_FFT_TILE),
+                                                           image.rows + kernel.rows - 1));
+            int tile_cols = cv::getOptimalDFTSize(std::min(std::max(FFT_TILE_FACTOR * kernel.cols, MIN_FFT_TILE),
+                                                           image.cols + kernel.cols - 1));
+            std::shared_ptr<const cv::Mat> spectrum = kernelSpectrum(kernel, tile_rows, tile_cols);
+
+            int step_rows = tile_rows - kernel.rows + 1;
+            int step_cols = tile_cols - kernel.cols + 1;
+            int grid_rows = (image.rows + step_rows - 1) / step_rows;
+            int grid_cols = (image.cols + step_cols - 1) / step_cols;
+
+            // 各分块读取相邻分块的输入，原地处理时先复制原图
+            cv::Mat input = dst.data == image.data ? image.clone() : image;
+            dst.create(input.rows, input.cols, input.type());
+            PixelKernels::dispatch(input.depth(), input.channels(), [&](auto format)
+                                   {
+                typedef typename decltype(format)::value_type T;
+                constexpr int CN = decltype(format)::channels;
+                Parallel::forEachRowBand(grid_rows * grid_cols, step_rows * step_cols, [&](const cv::Range &tiles)
+                                         {
+                    cv::Mat plane(tile_rows, tile_cols, CV_32F);
+                    std::vector<int> columns;
+                    for (int t = tiles.start; t < tiles.end; ++t)
+                    {
+                        convolveTile<T, CN>(input, dst, *spectrum, kernel.size(), t / grid_cols * step_rows,
+                                            t % grid_cols * step_cols, plane, columns);
+                    } }); });
+        }
+
+        const char *methodName(ConvolutionMethod method)
+        {
+            switch (method)
+            {
+            case ConvolutionMethod::DIRECT:
+                return "direct";
+            case ConvolutionMethod::SEPARABLE:
+                return "separable";
+            case ConvolutionMethod::FFT:
+                return "FFT";
+            default:
+                return "auto";
+            }
+        }
+    }
+
+    cv::Mat Convolution::filter(const cv::Mat &image, const cv::Mat &kernel, ConvolutionMethod method)
+    {
+        cv::Mat result;
+        return filter(image, result, kernel, method) ? result : cv::Mat();
+    }
+
+    bool Convolution::filter(const cv::Mat &image, cv::Mat &dst, const cv::Mat &kernel, ConvolutionMethod method)
+    {
+        if (image.empty())
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot apply convolution to empty image");
+            return false;
+        }
+
+        int depth = image.depth();
+        int channels = image.channels();
+        if (!((depth == CV_8U || depth == CV_16U || depth == CV_32F) && (channels == 1 || channels == 3 || channels == 4)))
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Unsupported image format for convolution");
+            return false;
+        }
+
+        if (kernel.empty() || kernel.channels() != 1 || (kernel.depth() != CV_32F && kernel.depth() != CV_64F) ||
+            kernel.rows > MAX_KERNEL_SIZE || kernel.cols > MAX_KERNEL_SIZE)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Convolution kernel must be a single-channel float matrix of at most " +
+                                                      std::to_string(MAX_KERNEL_SIZE) + "x" + std::to_string(MAX_KERNEL_SIZE));
+            return false;
+        }
+
+        cv::Mat kernel64;
+        kernel.convertTo(kernel64, CV_64F);
+        if (!cv::checkRange(kernel64))
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Convolution kernel contains non-finite values");
+            return false;
+        }
+
+        if (method == ConvolutionMethod::AUTO)
+        {
+            method = selectMethod(kernel64);
+        }
+
+        cv::Mat column, row;
+        if (method == ConvolutionMethod::SEPARABLE && !separateKernel(kernel64, column, row))
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Convolution kernel is not separable");
+            return false;
+        }
+
+        switch (method)
+        {
+        case ConvolutionMethod::SEPARABLE:
+            cv::sepFilter2D(image, dst, -1, row, column, cv::Point(-1, -1), 0, cv::BORDER_REPLICATE);
+            break;
+        case ConvolutionMethod::FFT:
+            convolveFFT(image, dst, kernel64);
+            break;
+        default:
+            cv::filter2D(image, dst, -1, kernel64, cv::Point(-1, -1), 0, cv::BORDER_REPLICATE);
+            break;
+        }
+
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Convolution applied with " + std::to_string(kernel.cols) + "x" +
+                                                 std::to_string(kernel.rows) + " kernel (" + methodName(method) + ")");
+        return true;
+    }
+
+    ConvolutionMethod Convolution::selectMethod(const cv::Mat &kernel)
+    {
+        cv::Mat kernel64, column, row;
+        kernel.convertTo(kernel64, CV_64F);
+        if (kernel64.rows * kernel64.cols > 1 && separateKernel(kernel64, column, row))
+        {
+            return ConvolutionMethod::SEPARABLE;
+        }
+        return kernel64.rows * kernel64.cols <= MAX_DIRECT_AREA ? ConvolutionMethod::DIRECT : ConvolutionMethod::FFT;
+    }
+
+    void Convolution::clearCache()
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        cache.clear();
+        cache_order.clear();
+    }
+
+    size_t Convolution::cacheSize()
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        return cache.size();
+    }
+
+} // namespace image_processor
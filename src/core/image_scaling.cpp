@@ -1,5 +1,6 @@
 #include "image_scaling.hpp"
 #include "logger.hpp"
+#include "resampler.hpp"
 #include <opencv2/imgproc.hpp>
 #include <stdexcept>
 #include <algorithm>
@@ -11,6 +12,14 @@ namespace image_processor
 
     cv::Mat ImageScaling::scaleImage(const cv::Mat &image, int new_width, int new_height,
                                      const std::string &method)
+    {
+        cv::Mat result;
+        scaleImage(image, result, new_width, new_height, method);
+        return result;
+    }
+
+    void ImageScaling::scaleImage(const cv::Mat &image, cv::Mat &dst, int new_width, int new_height,
+                                  const std::string &method)
     {
         if (image.empty())
         {
@@ -24,23 +33,57 @@ namespace image_processor
             throw std::invalid_argument("New dimensions must be positive");
         }
 
-        // 根据缩放要求动态选择插值算法
-        double scale_factor_x = static_cast<double>(new_width) / image.cols;
-        double scale_factor_y = static_cast<double>(new_height) / image.rows;
-        double avg_scale_factor = (scale_factor_x + scale_factor_y) / 2.0;
+        InterpolationMethod interp_method = resolveInterpolationMethod(image.size(), new_width, new_height, method);
+        bool resampler = interp_method == InterpolationMethod::RESAMPLE_CUBIC ||
+                         interp_method == InterpolationMethod::RESAMPLE_LANCZOS3;
 
-        InterpolationMethod interp_method = selectInterpolationMethod(avg_scale_factor, method);
+        // 整数倍的近邻放大和区域缩小直接使用像素复制和方框平均，结果（包括均值的取整方式）与对应插值方法在整数倍时相同
+        int factor = integerFactor(image, cv::Size(new_width, new_height), interp_method);
+        if (factor > 1 && interp_method == InterpolationMethod::NEAREST && Resampler::replicate(image, dst, factor))
+        {
+            Logger::log(LogLevel::IP_LOGLV_INFO, "Image scaled by pixel replication: x" + std::to_string(factor));
+            return;
+        }
+        if (factor < -1 && interp_method == InterpolationMethod::AREA && Resampler::boxReduce(image, dst, -factor))
+        {
+            Logger::log(LogLevel::IP_LOGLV_INFO, "Image scaled by box reduction: 1/" + std::to_string(-factor));
+            return;
+        }
 
-        int interpolation = convertInterpolationMethod(interp_method);
-        cv::Mat result;
-        cv::resize(image, result, cv::Size(new_width, new_height), 0, 0, interpolation);
+        // 区域插值和内置重采样器在大倍数缩小时先做 2 倍方框金字塔，最后只从金字塔的一层做一次重采样
+        cv::Mat source = image;
+        if (resampler || interp_method == InterpolationMethod::AREA)
+        {
+            source = Resampler::pyramidLevel(image, cv::Size(new_width, new_height));
+        }
+
+        if (resampler)
+        {
+            ResampleFilter filter = interp_method == InterpolationMethod::RESAMPLE_CUBIC ? ResampleFilter::CUBIC
+                                                                                         : ResampleFilter::LANCZOS3;
+            if (!Resampler::resize(source, dst, cv::Size(new_width, new_height), filter))
+            {
+                throw std::invalid_argument("Unsupported image format for resampling");
+            }
+        }
+        else
+        {
+            cv::resize(source, dst, cv::Size(new_width, new_height), 0, 0, convertInterpolationMethod(interp_method));
+        }
         Logger::log(LogLevel::IP_LOGLV_INFO,
                     "Image scaled: " + std::to_string(new_width) + "x" + std::to_string(new_height) + " using method: " + method);
-        return result;
     }
 
     cv::Mat ImageScaling::scaleImageByFactor(const cv::Mat &image, double scale_factor,
                                              const std::string &method)
+    {
+        cv::Mat result;
+        scaleImageByFactor(image, result, scale_factor, method);
+        return result;
+    }
+
+    void ImageScaling::scaleImageByFactor(const cv::Mat &image, cv::Mat &dst, double scale_factor,
+                                          const std::string &method)
     {
         if (image.empty())
         {
@@ -59,7 +102,7 @@ namespace image_processor
 
         InterpolationMethod interp_method = selectInterpolationMethod(scale_factor, method);
 
-        return scaleImage(image, new_width, new_height, method);
+        scaleImage(image, dst, new_width, new_height, method);
     }
 
     cv::Mat ImageScaling::enlargeImage(const cv::Mat &image, int new_width, int new_height,
@@ -90,6 +133,48 @@ namespace image_processor
         return scaleImage(image, new_width, new_height, method);
     }
 
+    int ImageScaling::interpolationFor(const cv::Size &image_size, int new_width, int new_height,
+                                       const std::string &method)
+    {
+        return convertInterpolationMethod(resolveInterpolationMethod(image_size, new_width, new_height, method));
+    }
+
+    // 辅助函数：按缩放要求解析出实际使用的插值方法
+    InterpolationMethod ImageScaling::resolveInterpolationMethod(const cv::Size &image_size, int new_width, int new_height,
+                                                                 const std::string &method)
+    {
+        // 根据缩放要求动态选择插值算法
+        double scale_factor_x = static_cast<double>(new_width) / image_size.width;
+        double scale_factor_y = static_cast<double>(new_height) / image_size.height;
+        double avg_scale_factor = (scale_factor_x + scale_factor_y) / 2.0;
+
+        return selectInterpolationMethod(avg_scale_factor, method);
+    }
+
+    // 辅助函数：两个方向的缩放比例为同一整数倍时返回倍数（放大为正，缩小为负），否则返回 0
+    int ImageScaling::integerFactor(const cv::Mat &image, const cv::Size &size, InterpolationMethod method)
+    {
+        int channels = image.channels();
+        if (image.depth() != CV_8U || !(channels == 1 || channels == 3 || channels == 4) ||
+            (method != InterpolationMethod::NEAREST && method != InterpolationMethod::AREA))
+        {
+            return 0;
+        }
+
+        for (int factor = 2; factor <= MAX_INTEGER_FACTOR; ++factor)
+        {
+            if (size.width == image.cols * factor && size.height == image.rows * factor)
+            {
+                return factor;
+            }
+            if (image.cols == size.width * factor && image.rows == size.height * factor)
+            {
+                return -factor;
+            }
+        }
+        return 0;
+    }
+
     // 辅助函数：将字符串转换为插值方法枚举
     InterpolationMethod ImageScaling::stringToInterpolationMethod(const std::string &method_str)
     {
@@ -118,6 +203,14 @@ namespace image_processor
         {
             return InterpolationMethod::LANCZOS;
         }
+        else if (lower_method == "resample_cubic")
+        {
+            return InterpolationMethod::RESAMPLE_CUBIC;
+        }
+        else if (lower_method == "lanczos3" || lower_method == "resample_lanczos3")
+        {
+            return InterpolationMethod::RESAMPLE_LANCZOS3;
+        }
         else
         {
             // 默认返回LINEAR
@@ -172,6 +265,9 @@ namespace image_processor
             return cv::INTER_AREA;
         case InterpolationMethod::LANCZOS:
             return cv::INTER_LANCZOS4;
+        case InterpolationMethod::RESAMPLE_CUBIC:
+        case InterpolationMethod::RESAMPLE_LANCZOS3:
+            return -1;
         default:
             return cv::INTER_LINEAR;
         }
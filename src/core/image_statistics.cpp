@@ -0,0 +1,229 @@
+#include "image_statistics.hpp"
+#include "logger.hpp"
+#include "parallel.hpp"
+#include "pixel_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <type_traits>
+
+namespace image_processor
+{
+
+    namespace
+    {
+        // 统计时使用的细分箱数：8 位图像每个取值一个分箱，16 位和浮点图像使用 12 位精度
+        const int HIGH_DEPTH_BINS = 4096;
+
+        // 自动抽样时的目标像素数
+        const double AUTO_SAMPLE_PIXELS = 1 << 20;
+
+        inline int fineBin(uchar value) { return value; }
+        inline int fineBin(ushort value) { return value >> 4; }
+        // NaN 和负值落入第一个分箱，大于等于 1 的值（包括正无穷）落入最后一个分箱，避免对非有限值做整数转换
+        inline int fineBin(float value)
+        {
+            if (!(value >= 0.0f))
+            {
+                return 0;
+            }
+            if (value >= 1.0f)
+            {
+                return HIGH_DEPTH_BINS - 1;
+            }
+            return std::min(static_cast<int>(value * HIGH_DEPTH_BINS), HIGH_DEPTH_BINS - 1);
+        }
+
+        // 各行带的局部统计结果
+        struct PartialStats
+        {
+            std::vector<uint64_t> histogram; // channels * bins
+            std::vector<double> sum;
+            std::vector<double> min;
+            std::vector<double> max;
+            uint64_t count = 0;
+
+            PartialStats(int channels, int bins)
+                : histogram(static_cast<size_t>(channels) * bins, 0), sum(channels, 0.0),
+                  min(channels, std::numeric_limits<double>::max()), max(channels, std::numeric_limits<double>::lowest())
+            {
+            }
+
+            void merge(const PartialStats &other)
+            {
+                count += other.count;
+                for (size_t k = 0; k < histogram.size(); ++k)
+                {
+                    histogram[k] += other.histogram[k];
+                }
+                for (size_t c = 0; c < sum.size(); ++c)
+                {
+                    sum[c] += other.sum[c];
+                    min[c] = std::min(min[c], other.min[c]);
+                    max[c] = std::max(max[c], other.max[c]);
+                }
+            }
+        };
+
+        // 在一个行带内统计所有通道；每行的和与最值先在像素类型上累计，内层循环可以向量化
+        // 抽样时只统计行号和列号都是 step 整数倍的像素，与行带的划分无关
+        template <typename T, int CN>
+        void accumulateRows(const cv::Mat &image, const cv::Range &rows, int bins, int step, PartialStats &stats)
+        {
+            typedef typename std::conditional<std::is_same<T, float>::value, double, int64_t>::type Accumulator;
+            int first_row = (rows.start + step - 1) / step * step;
+            int row_samples = (image.cols + step - 1) / step;
+            for (int i = first_row; i < rows.end; i += step)
+            {
+                const T *row = image.ptr<T>(i);
+                Accumulator row_sum[CN] = {};
+                T row_min[CN];
+                T row_max[CN];
+                for (int c = 0; c < CN; ++c)
+                {
+                    row_min[c] = row_max[c] = row[c];
+                }
+
+                for (int j = 0; j < row_samples; ++j)
+                {
+                    for (int c = 0; c < CN; ++c)
+                    {
+                        T value = row[j * step * CN + c];
+                        ++stats.histogram[c * bins + fineBin(value)];
+                        row_sum[c] += value;
+                        row_min[c] = std::min(row_min[c], value);
+                        row_max[c] = std::max(row_max[c], value);
+                    }
+                }
+
+                stats.count += row_samples;
+                for (int c = 0; c < CN; ++c)
+                {
+                    stats.sum[c] += static_cast<double>(row_sum[c]);
+                    stats.min[c] = std::min(stats.min[c], static_cast<double>(row_min[c]));
+                    stats.max[c] = std::max(stats.max[c], static_cast<double>(row_max[c]));
+                }
+            }
+        }
+
+        // 细分箱对应的取值：8 位图像为分箱本身，其余为分箱中点
+        double binValue(int bin, int depth)
+        {
+            switch (depth)
+            {
+            case CV_8U:
+                return bin;
+            case CV_16U:
+                return bin * 16 + 7.5;
+            default:
+                return (bin + 0.5) / HIGH_DEPTH_BINS;
+            }
+        }
+    }
+
+    int ImageStatistics::autoSampleStep(const cv::Mat &image)
+    {
+        return std::max(1, static_cast<int>(std::sqrt(static_cast<double>(image.total()) / AUTO_SAMPLE_PIXELS)));
+    }
+
+    bool ImageStatistics::compute(const cv::Mat &image, ImageStats &stats, const std::vector<double> &percentile_levels,
+                                  int sample_step)
+    {
+        if (image.empty())
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot compute statistics of empty image");
+            return false;
+        }
+
+        if (sample_step < 1)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Sample step must be at least 1");
+            return false;
+        }
+
+        for (double level : percentile_levels)
+        {
+            if (!(level >= 0.0 && level <= 100.0))
+            {
+                Logger::log(LogLevel::IP_LOGLV_ERROR, "Percentile levels must be between 0 and 100");
+                return false;
+            }
+        }
+
+        int channels = image.channels();
+        int bins = image.depth() == CV_8U ? 256 : HIGH_DEPTH_BINS;
+        PartialStats total(channels, bins);
+        std::mutex merge_mutex;
+
+        bool supported = PixelKernels::dispatch(image.depth(), channels, [&](auto format)
+                                                {
+            typedef typename decltype(format)::value_type T;
+            constexpr int CN = decltype(format)::channels;
+            Parallel::forEachRowBand(image, [&](const cv::Range &rows)
+                                     {
+                PartialStats local(CN, bins);
+                accumulateRows<T, CN>(image, rows, bins, sample_step, local);
+
+                std::lock_guard<std::mutex> lock(merge_mutex);
+                total.merge(local); }); });
+
+        if (!supported)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Unsupported image format for statistics");
+            return false;
+        }
+
+        stats.width = image.cols;
+        stats.height = image.rows;
+        stats.depth = image.depth();
+        stats.max_value = PixelKernels::maxValue(image.depth());
+        stats.sample_step = sample_step;
+        stats.samples = total.count;
+        stats.percentile_levels = percentile_levels;
+        stats.channels.assign(channels, ChannelStats());
+
+        uint64_t pixels = total.count;
+        int group = bins / HISTOGRAM_BINS;
+        for (int c = 0; c < channels; ++c)
+        {
+            ChannelStats &channel = stats.channels[c];
+            const uint64_t *fine = total.histogram.data() + static_cast<size_t>(c) * bins;
+
+            channel.mean = total.sum[c] / pixels;
+            channel.min = total.min[c];
+            channel.max = total.max[c];
+
+            channel.histogram.assign(HISTOGRAM_BINS, 0);
+            for (int k = 0; k < bins; ++k)
+            {
+                channel.histogram[k / group] += fine[k];
+            }
+
+            // 最近秩法：第 p 百分位为累计计数首次达到 ceil(p% * 像素数) 的分箱
+            for (double level : percentile_levels)
+            {
+                uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(level / 100.0 * pixels)));
+                uint64_t cumulative = 0;
+                int k = 0;
+                for (; k < bins - 1; ++k)
+                {
+                    cumulative += fine[k];
+                    if (cumulative >= rank)
+                    {
+                        break;
+                    }
+                }
+                // 结果不超出实际取值范围
+                channel.percentiles.push_back(std::min(std::max(binValue(k, image.depth()), channel.min), channel.max));
+            }
+        }
+
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Image statistics computed: " + std::to_string(image.cols) + "x" +
+                                                 std::to_string(image.rows) + ", " + std::to_string(channels) + " channels" +
+                                                 (sample_step > 1 ? ", sampled every " + std::to_string(sample_step) + " pixels" : ""));
+        return true;
+    }
+
+} // namespace image_processor
@@ -0,0 +1,163 @@
+#include "lookup_table.hpp"
+#include "logger.hpp"
+#include <opencv2/core.hpp>
+#include <string>
+
+namespace image_processor
+{
+
+    LookupTable::LookupTable(int channels)
+    {
+        if (channels < 1 || channels > 4)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Lookup table channels must be between 1 and 4");
+            return;
+        }
+
+        table_.create(1, 256, CV_8UC(channels));
+        for (int i = 0; i < 256; ++i)
+        {
+            uchar *entry = table_.ptr<uchar>(0) + i * channels;
+            for (int c = 0; c < channels; ++c)
+            {
+                entry[c] = static_cast<uchar>(i);
+            }
+        }
+    }
+
+    LookupTable::LookupTable(const LookupTable &other) : table_(other.table_.clone())
+    {
+    }
+
+    LookupTable &LookupTable::operator=(const LookupTable &other)
+    {
+        if (this != &other)
+        {
+            table_ = other.table_.clone();
+        }
+        return *this;
+    }
+
+    bool LookupTable::addBrightness(int brightness, int channel)
+    {
+        // 与 ColorProcessing::adjustBrightness 的换算一致
+        return addBrightnessContrast(1.0, brightness * 2.0, channel);
+    }
+
+    bool LookupTable::addContrast(int contrast, int channel)
+    {
+        // 与 ColorProcessing::adjustContrast 的换算一致
+        return addBrightnessContrast((contrast + 100.0) / 100.0, 0.0, channel);
+    }
+
+    bool LookupTable::addBrightnessContrast(double alpha, double beta, int channel)
+    {
+        // 表项直接用 convertTo 计算，舍入与饱和方式和逐像素处理完全一致
+        cv::Mat view = channelView(channel);
+        if (view.empty())
+        {
+            return false;
+        }
+
+        view.convertTo(view, -1, alpha, beta);
+        return true;
+    }
+
+    bool LookupTable::addInvert(int channel)
+    {
+        cv::Mat view = channelView(channel);
+        if (view.empty())
+        {
+            return false;
+        }
+
+        cv::bitwise_not(view, view);
+        return true;
+    }
+
+    bool LookupTable::compose(const LookupTable &next)
+    {
+        if (empty() || next.empty() || (next.channels() != 1 && next.channels() != channels()))
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot compose lookup tables with different channel counts");
+            return false;
+        }
+
+        cv::Mat composed;
+        cv::LUT(table_, next.table_, composed);
+        table_ = composed;
+        return true;
+    }
+
+    bool LookupTable::empty() const
+    {
+        return table_.empty();
+    }
+
+    int LookupTable::channels() const
+    {
+        return table_.channels();
+    }
+
+    uchar LookupTable::value(int channel, int input) const
+    {
+        return table_.ptr<uchar>(0)[input * channels() + channel];
+    }
+
+    void LookupTable::setValue(int channel, int input, uchar output)
+    {
+        table_.ptr<uchar>(0)[input * channels() + channel] = output;
+    }
+
+    const cv::Mat &LookupTable::table() const
+    {
+        return table_;
+    }
+
+    cv::Mat LookupTable::apply(const cv::Mat &image) const
+    {
+        cv::Mat result;
+        apply(image, result);
+        return result;
+    }
+
+    void LookupTable::apply(const cv::Mat &src, cv::Mat &dst) const
+    {
+        if (src.empty())
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot apply lookup table to empty image");
+            dst.release();
+            return;
+        }
+
+        if (empty() || src.depth() != CV_8U || (channels() != 1 && channels() != src.channels()))
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR,
+                        "Lookup table with " + std::to_string(channels()) + " channels cannot be applied to this image");
+            dst.release();
+            return;
+        }
+
+        // cv::LUT 内部按行并行并使用向量化查表
+        cv::LUT(src, table_, dst);
+    }
+
+    // 辅助函数：取出指定通道（或全部通道）的表项视图
+    cv::Mat LookupTable::channelView(int channel)
+    {
+        if (channel < 0)
+        {
+            return table_;
+        }
+
+        if (channel >= channels())
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Lookup table channel out of range: " + std::to_string(channel));
+            return cv::Mat();
+        }
+
+        // 256 x channels 的单通道视图中的一列即为该通道的表
+        return table_.reshape(1, 256).col(channel);
+    }
+
+} // namespace image_processor
@@ -0,0 +1,73 @@
+#include "parallel.hpp"
+#include "logger.hpp"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <string>
+
+namespace image_processor
+{
+
+    // 默认约 12 万像素（例如 350x350）以下的图像单线程执行
+    std::atomic<size_t> Parallel::min_parallel_pixels_(1 << 17);
+
+    namespace
+    {
+        // 每个线程分到的行带数，行带越多负载越均衡
+        const int BANDS_PER_THREAD = 4;
+    }
+
+    void Parallel::setThreadCount(int threads)
+    {
+        if (threads <= 0)
+        {
+            threads = cv::getNumberOfCPUs();
+        }
+        cv::setNumThreads(threads);
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Worker thread count set to " + std::to_string(threads));
+    }
+
+    int Parallel::threadCount()
+    {
+        return cv::getNumThreads();
+    }
+
+    void Parallel::setMinParallelPixels(size_t pixels)
+    {
+        min_parallel_pixels_ = pixels;
+    }
+
+    size_t Parallel::minParallelPixels()
+    {
+        return min_parallel_pixels_;
+    }
+
+    void Parallel::forEachRowBand(const cv::Mat &image, const std::function<void(const cv::Range &)> &body)
+    {
+        forEachRowBand(image.rows, image.cols, body);
+    }
+
+    void Parallel::forEachColumnBand(const cv::Mat &image, const std::function<void(const cv::Range &)> &body)
+    {
+        forEachRowBand(image.cols, image.rows, body);
+    }
+
+    void Parallel::forEachRowBand(int rows, int cols, const std::function<void(const cv::Range &)> &body)
+    {
+        if (rows <= 0 || cols <= 0)
+        {
+            return;
+        }
+
+        int threads = cv::getNumThreads();
+        size_t pixels = static_cast<size_t>(rows) * static_cast<size_t>(cols);
+        if (threads <= 1 || rows < 2 || pixels < min_parallel_pixels_)
+        {
+            body(cv::Range(0, rows));
+            return;
+        }
+
+        int bands = std::min(rows, threads * BANDS_PER_THREAD);
+        cv::parallel_for_(cv::Range(0, rows), body, bands);
+    }
+
+} // namespace image_processor
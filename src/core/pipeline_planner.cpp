@@ -0,0 +1,168 @@
+#include "pipeline_planner.hpp"
+#include "image_scaling.hpp"
+#include "pixel_kernels.hpp"
+#include "logger.hpp"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace image_processor
+{
+
+    // 默认允许 1 个 8 位色阶的平均误差，线性图层（亮度、对比度、反色、灰度化等）只有舍入和截断误差，通常在此范围内
+    std::atomic<double> PipelinePlanner::tolerance_(1.0);
+
+    namespace
+    {
+        // 缩小后的像素数至少减少到原来的 1/2 才值得调整顺序
+        const double MIN_PIXEL_RATIO = 2.0;
+
+        // 小图像直接按原顺序处理，省去取样比较的开销
+        const size_t MIN_PLANNED_PIXELS = 1 << 20;
+
+        // 每个样本在缩小后约为 SAMPLE_SIZE x SAMPLE_SIZE 像素
+        const int SAMPLE_SIZE = 64;
+
+        // 每个方向取 SAMPLE_GRID 个样本位置（起始边缘、等间距的中间位置、末尾边缘），共 SAMPLE_GRID^2 块
+        const int SAMPLE_GRID = 3;
+
+        // 取样本在一个方向上的长度和缩放后的尺寸
+        void sampleAxis(int src_size, int dst_size, int &length, int &scaled)
+        {
+            scaled = std::min(dst_size, SAMPLE_SIZE);
+            length = std::min(src_size, std::max(1, static_cast<int>(std::lround(static_cast<double>(scaled) * src_size / dst_size))));
+        }
+
+        // 第 index 个样本位置的起点，首尾两个样本贴住图像边缘
+        int sampleOffset(int src_size, int length, int index)
+        {
+            return static_cast<int>(static_cast<int64_t>(src_size - length) * index / (SAMPLE_GRID - 1));
+        }
+    }
+
+    size_t PipelinePlanner::scaleSplit(const cv::Mat &image, const ColorPipeline &pipeline, int new_width, int new_height,
+                                       const std::string &method, double tolerance)
+    {
+        size_t layers = pipeline.size();
+        size_t tail = pipeline.pointwiseTail();
+        if (tolerance <= 0.0 || tail >= layers || image.empty() || new_width <= 0 || new_height <= 0 ||
+            image.total() < MIN_PLANNED_PIXELS ||
+            static_cast<double>(new_width) * new_height * MIN_PIXEL_RATIO > static_cast<double>(image.total()))
+        {
+            return layers;
+        }
+
+        int width = 0, sample_width = 0;
+        int height = 0, sample_height = 0;
+        sampleAxis(image.cols, new_width, width, sample_width);
+        sampleAxis(image.rows, new_height, height, sample_height);
+
+        // 样本按网格分布在整幅图像上（包括四边和四角），原顺序的样本结果作为参照；
+        // 图像在某个方向上不比样本大时该方向只取一个位置
+        std::vector<cv::Mat> samples;
+        std::vector<cv::Mat> references;
+        int columns = width < image.cols ? SAMPLE_GRID : 1;
+        int rows = height < image.rows ? SAMPLE_GRID : 1;
+        for (int i = 0; i < rows; ++i)
+        {
+            for (int j = 0; j < columns; ++j)
+            {
+                int x = columns > 1 ? sampleOffset(image.cols, width, j) : 0;
+                int y = rows > 1 ? sampleOffset(image.rows, height, i) : 0;
+                cv::Mat sample = image(cv::Rect(x, y, width, height));
+                cv::Mat reference;
+                if (!run(sample, reference, pipeline, layers, sample_width, sample_height, method))
+                {
+                    return layers;
+                }
+                samples.push_back(sample);
+                references.push_back(reference);
+            }
+        }
+
+        // 从移动最多图层的方案开始逐个尝试，误差取所有样本中的最大值
+        for (size_t split = tail; split < layers; ++split)
+        {
+            double error = 0.0;
+            for (size_t k = 0; k < samples.size() && error <= tolerance; ++k)
+            {
+                cv::Mat candidate;
+                if (!run(samples[k], candidate, pipeline, split, sample_width, sample_height, method) ||
+                    candidate.size() != references[k].size() || candidate.type() != references[k].type())
+                {
+                    error = std::numeric_limits<double>::infinity();
+                    break;
+                }
+                error = std::max(error, meanError(candidate, references[k]));
+            }
+
+            if (error <= tolerance)
+            {
+                Logger::log(LogLevel::IP_LOGLV_INFO, "Scaling moved ahead of " + std::to_string(layers - split) +
+                                                         " color layer(s), worst sample error: " + std::to_string(error));
+                return split;
+            }
+            Logger::log(LogLevel::IP_LOGLV_INFO, "Keeping " + std::to_string(layers - split) +
+                                                     " color layer(s) before scaling, sample error: " + std::to_string(error));
+        }
+        return layers;
+    }
+
+    bool PipelinePlanner::run(const cv::Mat &image, cv::Mat &dst, const ColorPipeline &pipeline, size_t split,
+                              int new_width, int new_height, const std::string &method)
+    {
+        // 各步骤的中间结果保存在局部图像中，image 与 dst 可以为同一图像
+        cv::Mat current = image;
+        ColorPipeline before = pipeline.slice(0, split);
+        if (!before.empty())
+        {
+            cv::Mat colored;
+            if (!before.apply(current, colored))
+            {
+                return false;
+            }
+            current = colored;
+        }
+
+        cv::Mat scaled;
+        ImageScaling::scaleImage(current, scaled, new_width, new_height, method);
+
+        ColorPipeline after = pipeline.slice(split, pipeline.size());
+        if (after.empty())
+        {
+            dst = scaled;
+            return true;
+        }
+        return after.apply(scaled, dst);
+    }
+
+    void PipelinePlanner::setTolerance(double tolerance)
+    {
+        tolerance_ = tolerance;
+    }
+
+    double PipelinePlanner::tolerance()
+    {
+        return tolerance_;
+    }
+
+    // 辅助函数：两个结果的平均绝对误差（取各通道的最大值，换算为 8 位色阶）
+    double PipelinePlanner::meanError(const cv::Mat &a, const cv::Mat &b)
+    {
+        cv::Mat difference;
+        cv::absdiff(a, b, difference);
+        cv::Scalar mean = cv::mean(difference);
+
+        double error = 0.0;
+        for (int c = 0; c < std::min(a.channels(), 4); ++c)
+        {
+            error = std::max(error, mean[c]);
+        }
+        return error * 255.0 / PixelKernels::maxValue(a.depth());
+    }
+
+} // namespace image_processor
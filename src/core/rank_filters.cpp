@@ -0,0 +1,470 @@
+#include "rank_filters.hpp"
+#include "logger.hpp"
+#include "parallel.hpp"
+#include "pixel_kernels.hpp"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace image_processor
+{
+
+    namespace
+    {
+        // 半径上限；中值滤波的窗口直方图计数为 32 位，列直方图计数为 16 位
+        const int MAX_MORPHOLOGY_RADIUS = 1000;
+        const int MAX_MEDIAN_RADIUS = 255;
+
+        // 3x3 和 5x5 中值滤波交给 cv::medianBlur（排序网络，各深度都支持），比直方图方法更快
+        const int MAX_SORTING_NETWORK_RADIUS = 2;
+
+        struct MaxOp
+        {
+            template <typename T>
+            static T apply(T a, T b) { return std::max(a, b); }
+        };
+
+        struct MinOp
+        {
+            template <typename T>
+            static T apply(T a, T b) { return std::min(a, b); }
+        };
+
+        // 检查图像和半径，不满足时输出错误日志
+        bool checkInput(const cv::Mat &image, int radius, int max_radius, const std::string &operation)
+        {
+            if (image.empty())
+            {
+                Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot apply " + operation + " to empty image");
+                return false;
+            }
+
+            int depth = image.depth();
+            int channels = image.channels();
+            if (!((depth == CV_8U || depth == CV_16U || depth == CV_32F) && (channels == 1 || channels == 3 || channels == 4)))
+            {
+                Logger::log(LogLevel::IP_LOGLV_ERROR, "Unsupported image format for " + operation);
+                return false;
+            }
+
+            if (radius < 1 || radius > max_radius)
+            {
+                Logger::log(LogLevel::IP_LOGLV_ERROR, "Radius for " + operation + " must be between 1 and " + std::to_string(max_radius));
+                return false;
+            }
+            return true;
+        }
+
+        inline int clampIndex(int index, int size)
+        {
+            return std::min(std::max(index, 0), size - 1);
+        }
+
+        // van Herk / Gil-Werman：把两端各延长 radius 个边缘像素的序列按窗口长度 k 分块，
+        // 块内分别求前缀极值 g 和后缀极值 h，窗口 [s, s + k - 1] 的极值为 Op(h[s], g[s + k - 1])，
+        // 每个元素只需约三次比较，与窗口长度无关
+        template <typename Op, typename T, int CN>
+        void herkRow(const T *src, T *dst, int width, int radius, std::vector<T> &g, std::vector<T> &h)
+        {
+            int k = 2 * radius + 1;
+            int length = (width + 2 * radius + k - 1) / k * k;
+            g.resize(static_cast<size_t>(length) * CN);
+            h.resize(static_cast<size_t>(length) * CN);
+            for (int block = 0; block < length; block += k)
+            {
+                for (int p = block; p < block + k; ++p)
+                {
+                    const T *value = src + clampIndex(p - radius, width) * CN;
+                    for (int c = 0; c < CN; ++c)
+                    {
+                        g[p * CN + c] = p == block ? value[c] : Op::apply(g[(p - 1) * CN + c], value[c]);
+                    }
+                }
+                for (int p = block + k - 1; p >= block; --p)
+                {
+                    const T *value = src + clampIndex(p - radius, width) * CN;
+                    for (int c = 0; c < CN; ++c)
+                    {
+                        h[p * CN + c] = p == block + k - 1 ? value[c] : Op::apply(h[(p + 1) * CN + c], value[c]);
+                    }
+                }
+            }
+
+            for (int e = 0; e < width * CN; ++e)
+            {
+                dst[e] = Op::apply(h[e], g[e + (k - 1) * CN]);
+            }
+        }
+
+        // 列方向的 van Herk / Gil-Werman：在一个列块内按行分块，前缀/后缀极值逐行计算，
+        // 内层循环沿连续内存可以向量化
+        template <typename Op, typename T>
+        void herkColumns(const cv::Mat &src, cv::Mat &dst, int first, int last, int radius)
+        {
+            int rows = src.rows;
+            int count = last - first;
+            int k = 2 * radius + 1;
+            int length = (rows + 2 * radius + k - 1) / k * k;
+            std::vector<T> g(static_cast<size_t>(length) * count);
+            std::vector<T> h(static_cast<size_t>(length) * count);
+            for (int block = 0; block < length; block += k)
+            {
+                for (int p = block; p < block + k; ++p)
+                {
+                    const T *row = src.ptr<T>(clampIndex(p - radius, rows)) + first;
+                    T *gp = g.data() + static_cast<size_t>(p) * count;
+                    if (p == block)
+                    {
+                        std::copy(row, row + count, gp);
+                        continue;
+                    }
+                    const T *previous = gp - count;
+                    for (int e = 0; e < count; ++e)
+                    {
+                        gp[e] = Op::apply(previous[e], row[e]);
+                    }
+                }
+                for (int p = block + k - 1; p >= block; --p)
+                {
+                    const T *row = src.ptr<T>(clampIndex(p - radius, rows)) + first;
+                    T *hp = h.data() + static_cast<size_t>(p) * count;
+                    if (p == block + k - 1)
+                    {
+                        std::copy(row, row + count, hp);
+                        continue;
+                    }
+                    const T *next = hp + count;
+                    for (int e = 0; e < count; ++e)
+                    {
+                        hp[e] = Op::apply(next[e], row[e]);
+                    }
+                }
+            }
+
+            for (int i = 0; i < rows; ++i)
+            {
+                const T *hp = h.data() + static_cast<size_t>(i) * count;
+                const T *gp = g.data() + static_cast<size_t>(i + k - 1) * count;
+                T *out = dst.ptr<T>(i) + first;
+                for (int e = 0; e < count; ++e)
+                {
+                    out[e] = Op::apply(hp[e], gp[e]);
+                }
+            }
+        }
+
+        // 二维窗口极值：行方向结果写入与原图同类型的中间图像（极值不产生新的取值，没有精度损失），
+        // 列方向再由中间图像写出，因此 dst 可以与原图共用内存
+        template <typename Op>
+        void rankExtreme(const cv::Mat &image, cv::Mat &dst, int radius)
+        {
+            cv::Mat input = image;
+            cv::Mat rows_done(input.rows, input.cols, input.type());
+            PixelKernels::dispatch(input.depth(), input.channels(), [&](auto format)
+                                   {
+                typedef typename decltype(format)::value_type T;
+                constexpr int CN = decltype(format)::channels;
+                Parallel::forEachRowBand(input, [&](const cv::Range &rows)
+                                         {
+                    std::vector<T> g, h;
+                    for (int i = rows.start; i < rows.end; ++i)
+                    {
+                        herkRow<Op, T, CN>(input.ptr<T>(i), rows_done.ptr<T>(i), input.cols, radius, g, h);
+                    } });
+
+                dst.create(input.rows, input.cols, input.type());
+                Parallel::forEachColumnBand(input, [&](const cv::Range &cols)
+                                            { herkColumns<Op, T>(rows_done, dst, cols.start * CN, cols.end * CN, radius); }); });
+        }
+
+        // 中值滤波的直方图分箱：8 位图像每个取值一个分箱（16 个粗分箱 x 16 个细分箱），结果精确；
+        // 16 位和浮点图像量化到 12 位（64 个粗分箱 x 64 个细分箱，与 ImageStatistics 的高位深分箱精度相同），
+        // 输出中值所在分箱的中心值：16 位误差不超过 8/65535，浮点误差不超过 1/8192，超出 [0, 1] 的浮点值按边界处理
+        template <typename T>
+        struct MedianBins;
+
+        template <>
+        struct MedianBins<uchar>
+        {
+            static const int COARSE = 16;
+            static const int FINE = 16;
+            static int bin(uchar value) { return value; }
+            static uchar value(int bin) { return static_cast<uchar>(bin); }
+        };
+
+        template <>
+        struct MedianBins<ushort>
+        {
+            static const int COARSE = 64;
+            static const int FINE = 64;
+            static int bin(ushort value) { return value >> 4; }
+            static ushort value(int bin) { return static_cast<ushort>((bin << 4) | 8); }
+        };
+
+        template <>
+        struct MedianBins<float>
+        {
+            static const int COARSE = 64;
+            static const int FINE = 64;
+            static int bin(float value)
+            {
+                // NaN 和负值落入第一个分箱，避免对非有限值做整数转换
+                if (!(value >= 0.0f))
+                {
+                    return 0;
+                }
+                return std::min(static_cast<int>(std::min(value, 1.0f) * (COARSE * FINE)), COARSE * FINE - 1);
+            }
+            static float value(int bin) { return (bin + 0.5f) / (COARSE * FINE); }
+        };
+
+        // 16 位和浮点图像的列直方图每列每通道有 4096 个计数，按列块处理以限制内存；8 位图像整行作为一个列块
+        const int MEDIAN_TILE_COLUMNS = 256;
+
+        // 恒定时间中值滤波（Perreault & Hébert）：每列维护覆盖 2r+1 行的列直方图，逐行下移时只加减一个像素；
+        // 窗口直方图随列滑动时加上进入的列直方图、减去离开的列直方图。直方图分为粗分箱和细分箱两级，
+        // 每步只更新粗分箱，细分箱在中值落入对应粗分箱时才按需追赶到当前位置，每个像素的计算量与半径无关
+        // 处理 rows 行中 cols 范围内的输出像素，列直方图覆盖 cols 两侧各延伸 radius 列（超出图像的列按边缘列处理）
+        template <typename T, int CN>
+        void medianRows(const cv::Mat &src, cv::Mat &dst, const cv::Range &rows, const cv::Range &cols, int radius)
+        {
+            typedef MedianBins<T> Bins;
+            const int COARSE = Bins::COARSE;
+            const int FINE = Bins::FINE;
+            int width = src.cols;
+            int height = src.rows;
+            int window = 2 * radius + 1;
+            uint32_t half = static_cast<uint32_t>(window) * window / 2;
+
+            // 局部列 0 对应图像列 cols.start - radius
+            int origin = cols.start - radius;
+            int span = cols.size() + 2 * radius;
+            std::vector<uint16_t> column_fine(static_cast<size_t>(span) * CN * COARSE * FINE, 0);
+            std::vector<uint16_t> column_coarse(static_cast<size_t>(span) * CN * COARSE, 0);
+            auto fineAt = [&](int x, int c)
+            { return column_fine.data() + (static_cast<size_t>(x - origin) * CN + c) * COARSE * FINE; };
+            auto coarseAt = [&](int x, int c)
+            { return column_coarse.data() + (static_cast<size_t>(x - origin) * CN + c) * COARSE; };
+            auto updateColumns = [&](int row, int delta)
+            {
+                const T *pixels = src.ptr<T>(clampIndex(row, height));
+                for (int x = origin; x < origin + span; ++x)
+                {
+                    const T *pixel = pixels + clampIndex(x, width) * CN;
+                    for (int c = 0; c < CN; ++c)
+                    {
+                        int value = Bins::bin(pixel[c]);
+                        fineAt(x, c)[value] += delta;
+                        coarseAt(x, c)[value / FINE] += delta;
+                    }
+                }
+            };
+
+            for (int k = rows.start - radius; k <= rows.start + radius; ++k)
+            {
+                updateColumns(k, 1);
+            }
+
+            std::vector<uint32_t> fine(static_cast<size_t>(COARSE) * FINE);
+            for (int i = rows.start; i < rows.end; ++i)
+            {
+                int enter = std::min(i + radius, height - 1);
+                int leave = std::max(i - radius - 1, 0);
+                if (i > rows.start && enter != leave)
+                {
+                    updateColumns(leave, -1);
+                    updateColumns(enter, 1);
+                }
+
+                T *out = dst.ptr<T>(i);
+                for (int c = 0; c < CN; ++c)
+                {
+                    uint32_t coarse[COARSE] = {};
+                    int position[COARSE]; // 各粗分箱的细分箱对应的窗口位置
+                    std::fill(position, position + COARSE, cols.start - window);
+                    for (int k = -radius; k <= radius; ++k)
+                    {
+                        const uint16_t *column = coarseAt(cols.start + k, c);
+                        for (int b = 0; b < COARSE; ++b)
+                        {
+                            coarse[b] += column[b];
+                        }
+                    }
+
+                    for (int x = cols.start; x < cols.end; ++x)
+                    {
+                        if (x > cols.start)
+                        {
+                            const uint16_t *enter_column = coarseAt(x + radius, c);
+                            const uint16_t *leave_column = coarseAt(x - radius - 1, c);
+                            for (int b = 0; b < COARSE; ++b)
+                            {
+                                coarse[b] += enter_column[b] - leave_column[b];
+                            }
+                        }
+
+                        // 在粗分箱中找到中值所在的分箱
+                        uint32_t sum = 0;
+                        int b = 0;
+                        for (; b < COARSE - 1 && sum + coarse[b] <= half; ++b)
+                        {
+                            sum += coarse[b];
+                        }
+
+                        // 细分箱落后较多时直接按窗口重建（window 列），否则逐列追赶（每列加减各一次）
+                        uint32_t *bucket = fine.data() + static_cast<size_t>(b) * FINE;
+                        if (2 * (x - position[b]) > window)
+                        {
+                            std::fill(bucket, bucket + FINE, 0u);
+                            for (int k = x - radius; k <= x + radius; ++k)
+                            {
+                                const uint16_t *column = fineAt(k, c) + b * FINE;
+                                for (int v = 0; v < FINE; ++v)
+                                {
+                                    bucket[v] += column[v];
+                                }
+                            }
+                        }
+                        else
+                        {
+                            for (int p = position[b] + 1; p <= x; ++p)
+                            {
+                                const uint16_t *enter_column = fineAt(p + radius, c) + b * FINE;
+                                const uint16_t *leave_column = fineAt(p - radius - 1, c) + b * FINE;
+                                for (int v = 0; v < FINE; ++v)
+                                {
+                                    bucket[v] += enter_column[v] - leave_column[v];
+                                }
+                            }
+                        }
+                        position[b] = x;
+
+                        int v = 0;
+                        for (; v < FINE - 1 && sum + bucket[v] <= half; ++v)
+                        {
+                            sum += bucket[v];
+                        }
+                        out[x * CN + c] = Bins::value(b * FINE + v);
+                    }
+                }
+            }
+        }
+    }
+
+    cv::Mat RankFilters::dilate(const cv::Mat &image, int radius)
+    {
+        cv::Mat result;
+        return dilate(image, result, radius) ? result : cv::Mat();
+    }
+
+    bool RankFilters::dilate(const cv::Mat &image, cv::Mat &dst, int radius)
+    {
+        if (!checkInput(image, radius, MAX_MORPHOLOGY_RADIUS, "dilation"))
+        {
+            return false;
+        }
+
+        rankExtreme<MaxOp>(image, dst, radius);
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Dilation applied with radius " + std::to_string(radius));
+        return true;
+    }
+
+    cv::Mat RankFilters::erode(const cv::Mat &image, int radius)
+    {
+        cv::Mat result;
+        return erode(image, result, radius) ? result : cv::Mat();
+    }
+
+    bool RankFilters::erode(const cv::Mat &image, cv::Mat &dst, int radius)
+    {
+        if (!checkInput(image, radius, MAX_MORPHOLOGY_RADIUS, "erosion"))
+        {
+            return false;
+        }
+
+        rankExtreme<MinOp>(image, dst, radius);
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Erosion applied with radius " + std::to_string(radius));
+        return true;
+    }
+
+    cv::Mat RankFilters::open(const cv::Mat &image, int radius)
+    {
+        cv::Mat result;
+        return open(image, result, radius) ? result : cv::Mat();
+    }
+
+    bool RankFilters::open(const cv::Mat &image, cv::Mat &dst, int radius)
+    {
+        if (!checkInput(image, radius, MAX_MORPHOLOGY_RADIUS, "opening"))
+        {
+            return false;
+        }
+
+        rankExtreme<MinOp>(image, dst, radius);
+        rankExtreme<MaxOp>(dst, dst, radius);
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Opening applied with radius " + std::to_string(radius));
+        return true;
+    }
+
+    cv::Mat RankFilters::close(const cv::Mat &image, int radius)
+    {
+        cv::Mat result;
+        return close(image, result, radius) ? result : cv::Mat();
+    }
+
+    bool RankFilters::close(const cv::Mat &image, cv::Mat &dst, int radius)
+    {
+        if (!checkInput(image, radius, MAX_MORPHOLOGY_RADIUS, "closing"))
+        {
+            return false;
+        }
+
+        rankExtreme<MaxOp>(image, dst, radius);
+        rankExtreme<MinOp>(dst, dst, radius);
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Closing applied with radius " + std::to_string(radius));
+        return true;
+    }
+
+    cv::Mat RankFilters::median(const cv::Mat &image, int radius)
+    {
+        cv::Mat result;
+        return median(image, result, radius) ? result : cv::Mat();
+    }
+
+    bool RankFilters::median(const cv::Mat &image, cv::Mat &dst, int radius)
+    {
+        if (!checkInput(image, radius, MAX_MEDIAN_RADIUS, "median filter"))
+        {
+            return false;
+        }
+
+        if (radius <= MAX_SORTING_NETWORK_RADIUS)
+        {
+            cv::medianBlur(image, dst, 2 * radius + 1);
+            Logger::log(LogLevel::IP_LOGLV_INFO, "Median filter applied with radius " + std::to_string(radius));
+            return true;
+        }
+
+        // 各行带读取相邻行带的原图，原地处理时先复制原图
+        cv::Mat input = dst.data == image.data ? image.clone() : image;
+        dst.create(input.rows, input.cols, input.type());
+        PixelKernels::dispatch(input.depth(), input.channels(), [&](auto format)
+                               {
+            typedef typename decltype(format)::value_type T;
+            constexpr int CN = decltype(format)::channels;
+            int tile = input.depth() == CV_8U ? input.cols : MEDIAN_TILE_COLUMNS;
+            Parallel::forEachRowBand(input, [&](const cv::Range &rows)
+                                     {
+                for (int first = 0; first < input.cols; first += tile)
+                {
+                    medianRows<T, CN>(input, dst, rows, cv::Range(first, std::min(input.cols, first + tile)), radius);
+                } }); });
+
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Median filter applied with radius " + std::to_string(radius));
+        return true;
+    }
+
+} // namespace image_processor
@@ -0,0 +1,536 @@
+#include "resampler.hpp"
+#include "logger.hpp"
+#include "parallel.hpp"
+#include "pixel_kernels.hpp"
+#include "simd_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace image_processor
+{
+
+    namespace
+    {
+        // 缓存的抽头表数量上限（每个方向一张），超出时淘汰最早加入的表
+        const size_t MAX_CACHED_TAP_TABLES = 64;
+
+        // 条带缓冲区（水平重采样结果）的目标大小，接近每个核心的 L2 缓存
+        const size_t STRIP_BUFFER_BYTES = 256 * 1024;
+
+        // 整数倍方框缩小的最大倍数（16 位列累加不会溢出）
+        const int MAX_BOX_FACTOR = 16;
+
+        std::mutex cache_mutex;
+        std::unordered_map<uint64_t, std::shared_ptr<const ResampleTaps>> cache;
+        std::deque<uint64_t> cache_order;
+
+        uint64_t tapsKey(int src_size, int dst_size, ResampleFilter filter)
+        {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(src_size)) << 32) ^
+                   (static_cast<uint64_t>(static_cast<uint32_t>(dst_size)) << 4) ^ static_cast<uint64_t>(filter);
+        }
+
+        bool supportedFormat(const cv::Mat &image)
+        {
+            int depth = image.depth();
+            int channels = image.channels();
+            return (depth == CV_8U || depth == CV_16U || depth == CV_32F) && (channels == 1 || channels == 3 || channels == 4);
+        }
+
+        double filterSupport(ResampleFilter filter)
+        {
+            return filter == ResampleFilter::LANCZOS3 ? 3.0 : 2.0;
+        }
+
+        double filterWeight(ResampleFilter filter, double x)
+        {
+            x = std::fabs(x);
+            if (filter == ResampleFilter::LANCZOS3)
+            {
+                if (x < 1e-8)
+                {
+                    return 1.0;
+                }
+                if (x >= 3.0)
+                {
+                    return 0.0;
+                }
+                double px = CV_PI * x;
+                return 3.0 * std::sin(px) * std::sin(px / 3.0) / (px * px);
+            }
+
+            // Keys 三次卷积，a = -0.5
+            const double a = -0.5;
+            if (x < 1.0)
+            {
+                return ((a + 2.0) * x - (a + 3.0)) * x * x + 1.0;
+            }
+            if (x < 2.0)
+            {
+                return ((a * x - 5.0 * a) * x + 8.0 * a) * x - 4.0 * a;
+            }
+            return 0.0;
+        }
+
+        // 计算抽头表：输出像素中心映射回输入坐标后按滤波器取权重，权重归一化，越界的权重合并到边缘像素；
+        // 缩小时滤波器按缩小倍数展宽，放大时保持原宽度；所有输出像素使用相同的抽头数，窗口不足时补零权重
+        std::shared_ptr<ResampleTaps> computeTaps(int src_size, int dst_size, ResampleFilter filter)
+        {
+            double ratio = static_cast<double>(src_size) / dst_size;
+            double stretch = std::max(1.0, ratio);
+            double support = filterSupport(filter) * stretch;
+
+            std::vector<std::vector<std::pair<int, double>>> windows(dst_size);
+            int taps = 1;
+            for (int i = 0; i < dst_size; ++i)
+            {
+                double center = (i + 0.5) * ratio - 0.5;
+                int first = static_cast<int>(std::floor(center - support)) + 1;
+                int last = static_cast<int>(std::floor(center + support));
+
+                std::vector<std::pair<int, double>> &window = windows[i];
+                double total = 0.0;
+                for (int k = first; k <= last; ++k)
+                {
+                    double weight = filterWeight(filter, (k - center) / stretch);
+                    if (weight == 0.0)
+                    {
+                        continue;
+                    }
+                    int index = std::min(std::max(k, 0), src_size - 1);
+                    if (!window.empty() && window.back().first == index)
+                    {
+                        window.back().second += weight;
+                    }
+                    else
+                    {
+                        window.emplace_back(index, weight);
+                    }
+                    total += weight;
+                }
+                if (window.empty())
+                {
+                    window.emplace_back(std::min(std::max(static_cast<int>(std::lround(center)), 0), src_size - 1), 1.0);
+                    total = 1.0;
+                }
+                for (auto &tap : window)
+                {
+                    tap.second /= total;
+                }
+                taps = std::max(taps, window.back().first - window.front().first + 1);
+            }
+
+            auto table = std::make_shared<ResampleTaps>();
+            table->taps = taps;
+            table->starts.resize(dst_size);
+            table->weights.assign(static_cast<size_t>(dst_size) * taps, 0.f);
+            table->fixed_weights.assign(static_cast<size_t>(dst_size) * taps, 0);
+            const double scale = static_cast<double>(1 << SimdKernels::RESAMPLE_WEIGHT_SHIFT);
+            for (int i = 0; i < dst_size; ++i)
+            {
+                const std::vector<std::pair<int, double>> &window = windows[i];
+                int start = std::max(std::min(window.front().first, src_size - taps), 0);
+                table->starts[i] = start;
+                float *weights = table->weights.data() + static_cast<size_t>(i) * taps;
+                short *fixed = table->fixed_weights.data() + static_cast<size_t>(i) * taps;
+                int total = 0;
+                int largest = 0;
+                for (const auto &tap : window)
+                {
+                    int k = tap.first - start;
+                    weights[k] = static_cast<float>(tap.second);
+                    fixed[k] = static_cast<short>(std::lround(tap.second * scale));
+                    total += fixed[k];
+                    if (std::abs(fixed[k]) > std::abs(fixed[largest]))
+                    {
+                        largest = k;
+                    }
+                }
+                // 把舍入误差补到绝对值最大的权重上，使平坦区域保持原值
+                fixed[largest] = static_cast<short>(fixed[largest] + (1 << SimdKernels::RESAMPLE_WEIGHT_SHIFT) - total);
+            }
+            return table;
+        }
+
+        // 按条带执行两遍重采样：输出行 [rows.start, rows.end) 按条带处理，每个条带先由 horizontal 把所需的输入行
+        // 写入缓冲区，再由 vertical 从缓冲区的行指针生成输出行；与上一条带重叠的输入行移到缓冲区开头直接复用
+        template <typename Buffer, typename Horizontal, typename Vertical>
+        void resampleStrips(const ResampleTaps &table, const cv::Range &rows, size_t row_elements,
+                            Horizontal horizontal, Vertical vertical)
+        {
+            int taps = table.taps;
+            int max_rows = std::max(taps, static_cast<int>(STRIP_BUFFER_BYTES / (row_elements * sizeof(Buffer))));
+            std::vector<Buffer> buffer(static_cast<size_t>(max_rows) * row_elements);
+            std::vector<const Buffer *> pointers(taps);
+
+            int cached_first = 0;
+            int cached_end = 0;
+            int y = rows.start;
+            while (y < rows.end)
+            {
+                int first = table.starts[y];
+                int end = y + 1;
+                while (end < rows.end && table.starts[end] + taps - first <= max_rows)
+                {
+                    ++end;
+                }
+                int last = table.starts[end - 1] + taps;
+
+                int reused = 0;
+                if (first >= cached_first && first < cached_end)
+                {
+                    reused = cached_end - first;
+                    std::copy(buffer.begin() + static_cast<size_t>(first - cached_first) * row_elements,
+                              buffer.begin() + static_cast<size_t>(cached_end - cached_first) * row_elements, buffer.begin());
+                }
+                for (int r = first + reused; r < last; ++r)
+                {
+                    horizontal(r, buffer.data() + static_cast<size_t>(r - first) * row_elements);
+                }
+                cached_first = first;
+                cached_end = last;
+
+                for (; y < end; ++y)
+                {
+                    for (int k = 0; k < taps; ++k)
+                    {
+                        pointers[k] = buffer.data() + static_cast<size_t>(table.starts[y] + k - first) * row_elements;
+                    }
+                    vertical(y, pointers.data());
+                }
+            }
+        }
+
+        // 浮点水平重采样一行（16 位和浮点图像）
+        template <typename T, int CN>
+        void horizontalRow(const T *in, float *out, int width, const ResampleTaps &table)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                const T *pixels = in + table.starts[x] * CN;
+                const float *weights = table.weights.data() + static_cast<size_t>(x) * table.taps;
+                float sum[CN] = {};
+                for (int k = 0; k < table.taps; ++k)
+                {
+                    for (int c = 0; c < CN; ++c)
+                    {
+                        sum[c] += weights[k] * pixels[k * CN + c];
+                    }
+                }
+                for (int c = 0; c < CN; ++c)
+                {
+                    out[x * CN + c] = sum[c];
+                }
+            }
+        }
+
+        // 浮点垂直重采样一行：内层循环沿连续内存可以向量化
+        template <typename T>
+        void verticalRow(const float *const *in, const float *weights, int taps, T *out, float *sum, int count)
+        {
+            std::fill(sum, sum + count, 0.f);
+            for (int k = 0; k < taps; ++k)
+            {
+                const float *row = in[k];
+                float weight = weights[k];
+                for (int e = 0; e < count; ++e)
+                {
+                    sum[e] += weight * row[e];
+                }
+            }
+            for (int e = 0; e < count; ++e)
+            {
+                out[e] = cv::saturate_cast<T>(sum[e]);
+            }
+        }
+
+        // 8 位图像：定点权重，水平和垂直都使用 SIMD 行内核，条带缓冲区保存 16 位中间值
+        void resampleBytes(const cv::Mat &src, cv::Mat &dst, const ResampleTaps &columns, const ResampleTaps &rows,
+                           const cv::Range &band)
+        {
+            int channels = src.channels();
+            int width = dst.cols;
+            size_t row_elements = static_cast<size_t>(width) * channels;
+            resampleStrips<short>(
+                rows, band, row_elements,
+                [&](int r, short *out)
+                { SimdKernels::resampleHorizontalRow(src.ptr<uchar>(r), out, width, channels, columns.starts.data(),
+                                                     columns.fixed_weights.data(), columns.taps); },
+                [&](int y, const short *const *in)
+                { SimdKernels::resampleVerticalRow(in, rows.fixed_weights.data() + static_cast<size_t>(y) * rows.taps,
+                                                   rows.taps, dst.ptr<uchar>(y), static_cast<int>(row_elements)); });
+        }
+
+        // 16 位和浮点图像：浮点权重，中间结果为浮点
+        template <typename T, int CN>
+        void resampleFloat(const cv::Mat &src, cv::Mat &dst, const ResampleTaps &columns, const ResampleTaps &rows,
+                           const cv::Range &band)
+        {
+            int width = dst.cols;
+            size_t row_elements = static_cast<size_t>(width) * CN;
+            std::vector<float> sum(row_elements);
+            resampleStrips<float>(
+                rows, band, row_elements,
+                [&](int r, float *out)
+                { horizontalRow<T, CN>(src.ptr<T>(r), out, width, columns); },
+                [&](int y, const float *const *in)
+                { verticalRow<T>(in, rows.weights.data() + static_cast<size_t>(y) * rows.taps, rows.taps, dst.ptr<T>(y),
+                                 sum.data(), static_cast<int>(row_elements)); });
+        }
+
+        // 16 位和浮点图像的 2x2 方框缩小；奇数尺寸的最后一行/列按边缘复制参与平均
+        template <typename T, int CN>
+        void halveRows(const cv::Mat &src, cv::Mat &dst, const cv::Range &rows)
+        {
+            int last_row = src.rows - 1;
+            int last_col = src.cols - 1;
+            for (int y = rows.start; y < rows.end; ++y)
+            {
+                const T *a = src.ptr<T>(2 * y);
+                const T *b = src.ptr<T>(std::min(2 * y + 1, last_row));
+                T *out = dst.ptr<T>(y);
+                for (int x = 0; x < dst.cols; ++x, out += CN)
+                {
+                    int x0 = 2 * x * CN;
+                    int x1 = std::min(2 * x + 1, last_col) * CN;
+                    for (int c = 0; c < CN; ++c)
+                    {
+                        out[c] = cv::saturate_cast<T>((static_cast<float>(a[x0 + c]) + a[x1 + c] + b[x0 + c] + b[x1 + c]) * 0.25f);
+                    }
+                }
+            }
+        }
+
+        // 8 位图像奇数宽度的最后一列：右侧按边缘复制，即上下两个像素的均值，舍入方式与 halveRow 相同
+        void halveLastColumn(const uchar *row0, const uchar *row1, uchar *dst, int channels)
+        {
+            for (int c = 0; c < channels; ++c)
+            {
+                dst[c] = static_cast<uchar>((row0[c] + row1[c] + 1) >> 1);
+            }
+        }
+    }
+
+    bool Resampler::resize(const cv::Mat &src, cv::Mat &dst, const cv::Size &size, ResampleFilter filter)
+    {
+        if (src.empty() || size.width <= 0 || size.height <= 0)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Invalid image or size for resampling");
+            return false;
+        }
+
+        if (!supportedFormat(src))
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Unsupported image format for resampling");
+            return false;
+        }
+
+        int depth = src.depth();
+        int channels = src.channels();
+
+        std::shared_ptr<const ResampleTaps> columns = taps(src.cols, size.width, filter);
+        std::shared_ptr<const ResampleTaps> rows = taps(src.rows, size.height, filter);
+
+        // dst 与 src 为同一图像时先保留输入，再分配输出
+        cv::Mat input = src;
+        if (dst.data == src.data)
+        {
+            dst = cv::Mat();
+        }
+        dst.create(size, input.type());
+
+        // 计算量与输入像素数成正比，按输入像素数决定是否并行
+        int work_cols = static_cast<int>(std::max<size_t>(size.width, input.total() / size.height));
+        Parallel::forEachRowBand(size.height, work_cols, [&](const cv::Range &band)
+                                 {
+            if (depth == CV_8U)
+            {
+                resampleBytes(input, dst, *columns, *rows, band);
+                return;
+            }
+            PixelKernels::dispatch(depth, channels, [&](auto format)
+                                   {
+                typedef typename decltype(format)::value_type T;
+                constexpr int CN = decltype(format)::channels;
+                resampleFloat<T, CN>(input, dst, *columns, *rows, band); }); });
+        return true;
+    }
+
+    bool Resampler::halve(const cv::Mat &src, cv::Mat &dst)
+    {
+        if (src.cols < 2 || src.rows < 2 || dst.data == src.data || !supportedFormat(src))
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Invalid image for 2x box reduction");
+            return false;
+        }
+
+        int depth = src.depth();
+        int channels = src.channels();
+
+        // 输出尺寸向上取整，奇数尺寸的最后一行/列不会在逐层缩小中丢失
+        dst.create((src.rows + 1) / 2, (src.cols + 1) / 2, src.type());
+        Parallel::forEachRowBand(dst.rows, src.cols, [&](const cv::Range &band)
+                                 {
+            if (depth == CV_8U)
+            {
+                int pairs = src.cols / 2;
+                for (int y = band.start; y < band.end; ++y)
+                {
+                    const uchar *row0 = src.ptr<uchar>(2 * y);
+                    const uchar *row1 = src.ptr<uchar>(std::min(2 * y + 1, src.rows - 1));
+                    uchar *out = dst.ptr<uchar>(y);
+                    SimdKernels::halveRow(row0, row1, out, pairs, channels);
+                    if (dst.cols > pairs)
+                    {
+                        size_t offset = static_cast<size_t>(pairs) * channels;
+                        halveLastColumn(row0 + 2 * offset, row1 + 2 * offset, out + offset, channels);
+                    }
+                }
+                return;
+            }
+            PixelKernels::dispatch(depth, channels, [&](auto format)
+                                   {
+                typedef typename decltype(format)::value_type T;
+                constexpr int CN = decltype(format)::channels;
+                halveRows<T, CN>(src, dst, band); }); });
+        return true;
+    }
+
+    bool Resampler::replicate(const cv::Mat &src, cv::Mat &dst, int factor)
+    {
+        int channels = src.channels();
+        if (src.empty() || src.depth() != CV_8U || !(channels == 1 || channels == 3 || channels == 4) || factor < 1)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Invalid image or factor for pixel replication");
+            return false;
+        }
+
+        cv::Mat input = src;
+        if (dst.data == src.data)
+        {
+            dst = cv::Mat();
+        }
+        dst.create(input.rows * factor, input.cols * factor, input.type());
+
+        size_t row_bytes = static_cast<size_t>(dst.cols) * channels;
+        Parallel::forEachRowBand(input.rows, dst.cols * factor, [&](const cv::Range &band)
+                                 {
+            for (int y = band.start; y < band.end; ++y)
+            {
+                uchar *first = dst.ptr<uchar>(y * factor);
+                SimdKernels::replicateRow(input.ptr<uchar>(y), first, input.cols, channels, factor);
+                for (int r = 1; r < factor; ++r)
+                {
+                    std::memcpy(dst.ptr<uchar>(y * factor + r), first, row_bytes);
+                }
+            } });
+        return true;
+    }
+
+    bool Resampler::boxReduce(const cv::Mat &src, cv::Mat &dst, int factor)
+    {
+        int channels = src.channels();
+        if (src.empty() || src.depth() != CV_8U || !(channels == 1 || channels == 3 || channels == 4) ||
+            factor < 2 || factor > MAX_BOX_FACTOR || src.cols % factor != 0 || src.rows % factor != 0)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Invalid image or factor for box reduction");
+            return false;
+        }
+
+        cv::Mat input = src;
+        if (dst.data == src.data)
+        {
+            dst = cv::Mat();
+        }
+        dst.create(input.rows / factor, input.cols / factor, input.type());
+
+        Parallel::forEachRowBand(dst.rows, input.cols * factor, [&](const cv::Range &band)
+                                 {
+            const uchar *rows[MAX_BOX_FACTOR];
+            for (int y = band.start; y < band.end; ++y)
+            {
+                for (int r = 0; r < factor; ++r)
+                {
+                    rows[r] = input.ptr<uchar>(y * factor + r);
+                }
+                SimdKernels::boxReduceRow(rows, factor, dst.ptr<uchar>(y), dst.cols, channels);
+            } });
+        return true;
+    }
+
+    cv::Mat Resampler::pyramidLevel(const cv::Mat &src, const cv::Size &size)
+    {
+        // 其他格式不建立金字塔，由调用方直接缩放
+        cv::Mat level = src;
+        if (!supportedFormat(src))
+        {
+            return level;
+        }
+
+        while (buildsPyramid(level.size(), size))
+        {
+            cv::Mat next;
+            if (!halve(level, next))
+            {
+                break;
+            }
+            level = next;
+        }
+        return level;
+    }
+
+    bool Resampler::buildsPyramid(const cv::Size &src_size, const cv::Size &size)
+    {
+        return src_size.width / 2 >= 2 * size.width && src_size.height / 2 >= 2 * size.height;
+    }
+
+    std::shared_ptr<const ResampleTaps> Resampler::taps(int src_size, int dst_size, ResampleFilter filter)
+    {
+        uint64_t key = tapsKey(src_size, dst_size, filter);
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            auto it = cache.find(key);
+            if (it != cache.end())
+            {
+                return it->second;
+            }
+        }
+
+        // 在锁外计算，避免阻塞其他请求
+        std::shared_ptr<const ResampleTaps> table = computeTaps(src_size, dst_size, filter);
+
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        if (cache.emplace(key, table).second)
+        {
+            cache_order.push_back(key);
+            if (cache_order.size() > MAX_CACHED_TAP_TABLES)
+            {
+                cache.erase(cache_order.front());
+                cache_order.pop_front();
+            }
+        }
+        return table;
+    }
+
+    void Resampler::clearCache()
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        cache.clear();
+        cache_order.clear();
+    }
+
+    size_t Resampler::cacheSize()
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        return cache.size();
+    }
+
+} // namespace image_processor
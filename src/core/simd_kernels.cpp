@@ -0,0 +1,955 @@
+#include "simd_kernels.hpp"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define IP_SIMD_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define IP_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define IP_TARGET_AVX2
+#endif
+#endif
+
+namespace image_processor
+{
+
+    namespace
+    {
+        enum class InstructionSet
+        {
+            SCALAR,
+            SSE2,
+            AVX2
+        };
+
+        // 只在第一次调用时检测 CPU，之后直接使用缓存的结果
+        InstructionSet detectInstructionSet()
+        {
+#ifdef IP_SIMD_X86
+            if (cv::checkHardwareSupport(CV_CPU_AVX2))
+            {
+                return InstructionSet::AVX2;
+            }
+            return InstructionSet::SSE2;
+#else
+            return InstructionSet::SCALAR;
+#endif
+        }
+
+        InstructionSet instructionSet()
+        {
+            static const InstructionSet selected = detectInstructionSet();
+            return selected;
+        }
+
+        inline uchar clampToByte(int value)
+        {
+            return static_cast<uchar>(std::min(255, std::max(0, value)));
+        }
+
+        void weightedGrayRowScalar(const uchar *src, uchar *dst, int width, const FixedPointWeights &weights)
+        {
+            for (int j = 0; j < width; ++j, src += 3)
+            {
+                int sum = src[0] * weights.b + src[1] * weights.g + src[2] * weights.r;
+                dst[j] = clampToByte(sum >> SimdKernels::GRAY_WEIGHT_SHIFT);
+            }
+        }
+
+        // 计算交错数据中第 k 个字节（通道 channel）的饱和度调整结果
+        inline uchar saturationValue(const uchar *row, int k, int channel, const SaturationCoefficients &coefficients)
+        {
+            const int *taps = coefficients.taps[channel];
+            int sum = 1 << (SimdKernels::SATURATION_SHIFT - 1);
+            for (int d = -channel; d <= 2 - channel; ++d)
+            {
+                sum += row[k + d] * taps[d + 2];
+            }
+            return clampToByte(sum >> SimdKernels::SATURATION_SHIFT);
+        }
+
+        void saturationRangeScalar(const uchar *row, uchar *dst, int begin, int end, const SaturationCoefficients &coefficients)
+        {
+            for (int k = begin; k < end; ++k)
+            {
+                dst[k] = saturationValue(row, k, k % 3, coefficients);
+            }
+        }
+
+        // 水平结果保留 RESAMPLE_INTERMEDIATE_BITS 位小数，Lanczos 的过冲和下冲不会在两遍之间被截断
+        const int HORIZONTAL_SHIFT = SimdKernels::RESAMPLE_WEIGHT_SHIFT - SimdKernels::RESAMPLE_INTERMEDIATE_BITS;
+        const int VERTICAL_SHIFT = SimdKernels::RESAMPLE_WEIGHT_SHIFT + SimdKernels::RESAMPLE_INTERMEDIATE_BITS;
+
+        inline short clampToShort(int value)
+        {
+            return static_cast<short>(std::min(32767, std::max(-32768, value)));
+        }
+
+        void resampleHorizontalScalar(const uchar *src, short *dst, int begin, int end, int channels, const int *starts,
+                                      const short *weights, int taps)
+        {
+            for (int x = begin; x < end; ++x)
+            {
+                const uchar *pixels = src + starts[x] * channels;
+                const short *w = weights + static_cast<size_t>(x) * taps;
+                for (int c = 0; c < channels; ++c)
+                {
+                    int sum = 1 << (HORIZONTAL_SHIFT - 1);
+                    for (int k = 0; k < taps; ++k)
+                    {
+                        sum += w[k] * pixels[k * channels + c];
+                    }
+                    dst[x * channels + c] = clampToShort(sum >> HORIZONTAL_SHIFT);
+                }
+            }
+        }
+
+        void resampleVerticalScalar(const short *const *rows, const short *weights, int taps, uchar *dst, int begin, int end)
+        {
+            for (int e = begin; e < end; ++e)
+            {
+                int sum = 1 << (VERTICAL_SHIFT - 1);
+                for (int k = 0; k < taps; ++k)
+                {
+                    sum += weights[k] * rows[k][e];
+                }
+                dst[e] = clampToByte(sum >> VERTICAL_SHIFT);
+            }
+        }
+
+        void halveRowScalar(const uchar *row0, const uchar *row1, uchar *dst, int begin, int end, int channels)
+        {
+            for (int x = begin; x < end; ++x)
+            {
+                const uchar *a = row0 + 2 * x * channels;
+                const uchar *b = row1 + 2 * x * channels;
+                for (int c = 0; c < channels; ++c)
+                {
+                    dst[x * channels + c] = static_cast<uchar>((a[c] + a[c + channels] + b[c] + b[c + channels] + 2) >> 2);
+                }
+            }
+        }
+
+        template <int CN>
+        void replicateRowScalar(const uchar *src, uchar *dst, int begin, int end, int factor)
+        {
+            for (int x = begin; x < end; ++x)
+            {
+                uchar *out = dst + x * factor * CN;
+                for (int r = 0; r < factor; ++r, out += CN)
+                {
+                    for (int c = 0; c < CN; ++c)
+                    {
+                        out[c] = src[x * CN + c];
+                    }
+                }
+            }
+        }
+
+        void replicateRangeScalar(const uchar *src, uchar *dst, int begin, int end, int channels, int factor)
+        {
+            switch (channels)
+            {
+            case 1:
+                replicateRowScalar<1>(src, dst, begin, end, factor);
+                break;
+            case 3:
+                replicateRowScalar<3>(src, dst, begin, end, factor);
+                break;
+            case 4:
+                replicateRowScalar<4>(src, dst, begin, end, factor);
+                break;
+            default:
+                for (int x = begin; x < end; ++x)
+                {
+                    for (int r = 0; r < factor; ++r)
+                    {
+                        std::memcpy(dst + (x * factor + r) * channels, src + x * channels, channels);
+                    }
+                }
+                break;
+            }
+        }
+
+        // 每个输出像素对 FACTOR x FACTOR 个输入求和，sums 为已按列累加的 16 位行；倍数为常量时内层循环完全展开
+        // 均值的取整与 cv::resize 区域插值在整数倍时相同：和乘以单精度的 1 / 面积后按 cvRound 取整（五成双），
+        // 例如 4 倍缩小时和为 16k + 8 的块在 k 为偶数时向下取整
+        template <int FACTOR>
+        void boxReduceColumns(const ushort *sums, uchar *dst, int begin, int end, int channels, int factor)
+        {
+            const int step = FACTOR > 0 ? FACTOR : factor;
+            const float scale = 1.0f / static_cast<float>(step * step);
+            for (int x = begin; x < end; ++x)
+            {
+                const ushort *group = sums + (x - begin) * step * channels;
+                for (int c = 0; c < channels; ++c)
+                {
+                    int sum = 0;
+                    for (int i = 0; i < step; ++i)
+                    {
+                        sum += group[i * channels + c];
+                    }
+                    dst[x * channels + c] = cv::saturate_cast<uchar>(sum * scale);
+                }
+            }
+        }
+
+        void boxReduceColumnsAny(const ushort *sums, uchar *dst, int begin, int end, int channels, int factor)
+        {
+            switch (factor)
+            {
+            case 3:
+                boxReduceColumns<3>(sums, dst, begin, end, channels, factor);
+                break;
+            case 4:
+                boxReduceColumns<4>(sums, dst, begin, end, channels, factor);
+                break;
+            default:
+                boxReduceColumns<0>(sums, dst, begin, end, channels, factor);
+                break;
+            }
+        }
+
+        // 整数倍方框缩小按输出像素分块：每块先把 factor 行按列累加到栈上的 16 位缓冲区，再横向分组求均值
+        const int BOX_BLOCK_PIXELS = 128;
+        const int MAX_BOX_FACTOR = 16;
+
+        // 字节重排复制支持的最大倍数（每块最多写出该数量的 16 字节）
+        const int MAX_SHUFFLE_FACTOR = 8;
+
+        void boxReduceRowScalar(const uchar *const *rows, int factor, uchar *dst, int width, int channels)
+        {
+            ushort sums[BOX_BLOCK_PIXELS * MAX_BOX_FACTOR * 4];
+            for (int begin = 0; begin < width; begin += BOX_BLOCK_PIXELS)
+            {
+                int end = std::min(width, begin + BOX_BLOCK_PIXELS);
+                int offset = begin * factor * channels;
+                int count = (end - begin) * factor * channels;
+                for (int i = 0; i < count; ++i)
+                {
+                    int sum = 0;
+                    for (int r = 0; r < factor; ++r)
+                    {
+                        sum += rows[r][offset + i];
+                    }
+                    sums[i] = static_cast<ushort>(sum);
+                }
+                boxReduceColumnsAny(sums, dst, begin, end, channels, factor);
+            }
+        }
+
+#ifdef IP_SIMD_X86
+        // 把两个 16 位权重打包为一个 32 位整数，供 madd 指令使用（low 在低 16 位）
+        inline int packWeightPair(int low, int high)
+        {
+            return static_cast<int>((static_cast<unsigned>(high) << 16) | (static_cast<unsigned>(low) & 0xFFFFu));
+        }
+
+        // SSE2：每次处理 16 个像素，先把 BGR 交错数据拆分为三个平面
+        void weightedGrayRowSse2(const uchar *src, uchar *dst, int width, const FixedPointWeights &weights)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i weights_bg = _mm_set1_epi32(packWeightPair(weights.b, weights.g));
+            const __m128i weights_r = _mm_set1_epi32(packWeightPair(weights.r, 0));
+
+            int j = 0;
+            for (; j + 16 <= width; j += 16)
+            {
+                const uchar *p = src + 3 * j;
+                __m128i t00 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                __m128i t01 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16));
+                __m128i t02 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 32));
+
+                __m128i t10 = _mm_unpacklo_epi8(t00, _mm_unpackhi_epi64(t01, t01));
+                __m128i t11 = _mm_unpacklo_epi8(_mm_unpackhi_epi64(t00, t00), t02);
+                __m128i t12 = _mm_unpacklo_epi8(t01, _mm_unpackhi_epi64(t02, t02));
+
+                __m128i t20 = _mm_unpacklo_epi8(t10, _mm_unpackhi_epi64(t11, t11));
+                __m128i t21 = _mm_unpacklo_epi8(_mm_unpackhi_epi64(t10, t10), t12);
+                __m128i t22 = _mm_unpacklo_epi8(t11, _mm_unpackhi_epi64(t12, t12));
+
+                __m128i t30 = _mm_unpacklo_epi8(t20, _mm_unpackhi_epi64(t21, t21));
+                __m128i t31 = _mm_unpacklo_epi8(_mm_unpackhi_epi64(t20, t20), t22);
+                __m128i t32 = _mm_unpacklo_epi8(t21, _mm_unpackhi_epi64(t22, t22));
+
+                __m128i blue = _mm_unpacklo_epi8(t30, _mm_unpackhi_epi64(t31, t31));
+                __m128i green = _mm_unpacklo_epi8(_mm_unpackhi_epi64(t30, t30), t32);
+                __m128i red = _mm_unpacklo_epi8(t31, _mm_unpackhi_epi64(t32, t32));
+
+                __m128i result[2];
+                for (int half = 0; half < 2; ++half)
+                {
+                    __m128i b16 = half == 0 ? _mm_unpacklo_epi8(blue, zero) : _mm_unpackhi_epi8(blue, zero);
+                    __m128i g16 = half == 0 ? _mm_unpacklo_epi8(green, zero) : _mm_unpackhi_epi8(green, zero);
+                    __m128i r16 = half == 0 ? _mm_unpacklo_epi8(red, zero) : _mm_unpackhi_epi8(red, zero);
+
+                    __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(b16, g16), weights_bg),
+                                               _mm_madd_epi16(_mm_unpacklo_epi16(r16, zero), weights_r));
+                    __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(b16, g16), weights_bg),
+                                               _mm_madd_epi16(_mm_unpackhi_epi16(r16, zero), weights_r));
+                    lo = _mm_srai_epi32(lo, SimdKernels::GRAY_WEIGHT_SHIFT);
+                    hi = _mm_srai_epi32(hi, SimdKernels::GRAY_WEIGHT_SHIFT);
+                    result[half] = _mm_packs_epi32(lo, hi);
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + j), _mm_packus_epi16(result[0], result[1]));
+            }
+
+            weightedGrayRowScalar(src + 3 * j, dst + j, width - j, weights);
+        }
+
+        // AVX2：每个 128 位通道载入 4 个像素，用字节重排直接展开为 16 位
+        IP_TARGET_AVX2 void weightedGrayRowAvx2(const uchar *src, uchar *dst, int width, const FixedPointWeights &weights)
+        {
+            const __m256i shuffle_bg = _mm256_setr_epi8(0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10, -1,
+                                                        0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10, -1);
+            const __m256i shuffle_r = _mm256_setr_epi8(2, -1, -1, -1, 5, -1, -1, -1, 8, -1, -1, -1, 11, -1, -1, -1,
+                                                       2, -1, -1, -1, 5, -1, -1, -1, 8, -1, -1, -1, 11, -1, -1, -1);
+            const __m256i weights_bg = _mm256_set1_epi32(packWeightPair(weights.b, weights.g));
+            const __m256i weights_r = _mm256_set1_epi32(packWeightPair(weights.r, 0));
+            const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 0, 0, 0, 0);
+
+            // 每次载入 16 字节，需保证最后一次载入不越过行尾（16 个像素 = 48 字节）
+            int j = 0;
+            for (; 3 * j + 52 <= 3 * width; j += 16)
+            {
+                const uchar *p = src + 3 * j;
+                __m256i sums[2];
+                for (int part = 0; part < 2; ++part)
+                {
+                    const uchar *q = p + 24 * part;
+                    __m256i pixels = _mm256_inserti128_si256(
+                        _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(q))),
+                        _mm_loadu_si128(reinterpret_cast<const __m128i *>(q + 12)), 1);
+                    __m256i bg = _mm256_madd_epi16(_mm256_shuffle_epi8(pixels, shuffle_bg), weights_bg);
+                    __m256i r = _mm256_madd_epi16(_mm256_shuffle_epi8(pixels, shuffle_r), weights_r);
+                    sums[part] = _mm256_srai_epi32(_mm256_add_epi32(bg, r), SimdKernels::GRAY_WEIGHT_SHIFT);
+                }
+                // packs 按 128 位通道交错，最后用置换恢复像素顺序
+                __m256i packed = _mm256_packs_epi32(sums[0], sums[1]);
+                packed = _mm256_packus_epi16(packed, packed);
+                packed = _mm256_permutevar8x32_epi32(packed, order);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + j), _mm256_castsi256_si128(packed));
+            }
+
+            weightedGrayRowSse2(src + 3 * j, dst + j, width - j, weights);
+        }
+        // 生成 madd 所需的系数向量：lanes 个 32 位元素，每个元素打包一对相邻偏移的系数
+        // output_index 给出每个元素对应的输出字节相对位置
+        void buildSaturationPairs(const SaturationCoefficients &coefficients, int phase, const int *output_index,
+                                  int lanes, int pair, int *packed)
+        {
+            for (int lane = 0; lane < lanes; ++lane)
+            {
+                int channel = (phase + output_index[lane]) % 3;
+                int low = coefficients.taps[channel][2 * pair];
+                int high = pair < 2 ? coefficients.taps[channel][2 * pair + 1] : 0;
+                packed[lane] = packWeightPair(low, high);
+            }
+        }
+
+        // SSE2：每次处理 8 个输出字节，5 次错位载入后用 3 组 madd 完成 5 抽头加权
+        // 处理行内 [begin, total) 范围的字节，src/dst 指向行首
+        void saturationRowSse2(const uchar *src, uchar *dst, int begin, int total, const SaturationCoefficients &coefficients)
+        {
+            static const int output_lo[4] = {0, 1, 2, 3};
+            static const int output_hi[4] = {4, 5, 6, 7};
+            __m128i pairs[3][2][3];
+            for (int phase = 0; phase < 3; ++phase)
+            {
+                for (int pair = 0; pair < 3; ++pair)
+                {
+                    int packed[4];
+                    buildSaturationPairs(coefficients, phase, output_lo, 4, pair, packed);
+                    pairs[phase][0][pair] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(packed));
+                    buildSaturationPairs(coefficients, phase, output_hi, 4, pair, packed);
+                    pairs[phase][1][pair] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(packed));
+                }
+            }
+
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i rounding = _mm_set1_epi32(1 << (SimdKernels::SATURATION_SHIFT - 1));
+            // 第一个像素单独处理，保证向左错位 2 字节的载入不越过行首
+            int k = std::max(begin, std::min(3, total));
+            saturationRangeScalar(src, dst, begin, k, coefficients);
+            for (; k + 10 <= total; k += 8)
+            {
+                __m128i taps[5];
+                for (int d = 0; d < 5; ++d)
+                {
+                    taps[d] = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + k + d - 2)), zero);
+                }
+                const __m128i(&coef)[2][3] = pairs[k % 3];
+
+                __m128i lo = _mm_add_epi32(rounding, _mm_madd_epi16(_mm_unpacklo_epi16(taps[0], taps[1]), coef[0][0]));
+                lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(taps[2], taps[3]), coef[0][1]));
+                lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(taps[4], zero), coef[0][2]));
+                __m128i hi = _mm_add_epi32(rounding, _mm_madd_epi16(_mm_unpackhi_epi16(taps[0], taps[1]), coef[1][0]));
+                hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(taps[2], taps[3]), coef[1][1]));
+                hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(taps[4], zero), coef[1][2]));
+
+                __m128i packed = _mm_packs_epi32(_mm_srai_epi32(lo, SimdKernels::SATURATION_SHIFT),
+                                                 _mm_srai_epi32(hi, SimdKernels::SATURATION_SHIFT));
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + k), _mm_packus_epi16(packed, packed));
+            }
+            saturationRangeScalar(src, dst, k, total, coefficients);
+        }
+
+        // AVX2：每次处理 16 个输出字节，unpack 按 128 位通道进行，系数按相同的顺序排列
+        IP_TARGET_AVX2 void saturationRowAvx2(const uchar *src, uchar *dst, int begin, int total, const SaturationCoefficients &coefficients)
+        {
+            static const int output_lo[8] = {0, 1, 2, 3, 8, 9, 10, 11};
+            static const int output_hi[8] = {4, 5, 6, 7, 12, 13, 14, 15};
+            __m256i pairs[3][2][3];
+            for (int phase = 0; phase < 3; ++phase)
+            {
+                for (int pair = 0; pair < 3; ++pair)
+                {
+                    int packed[8];
+                    buildSaturationPairs(coefficients, phase, output_lo, 8, pair, packed);
+                    pairs[phase][0][pair] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(packed));
+                    buildSaturationPairs(coefficients, phase, output_hi, 8, pair, packed);
+                    pairs[phase][1][pair] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(packed));
+                }
+            }
+
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i rounding = _mm256_set1_epi32(1 << (SimdKernels::SATURATION_SHIFT - 1));
+            int k = std::max(begin, std::min(3, total));
+            saturationRangeScalar(src, dst, begin, k, coefficients);
+            for (; k + 18 <= total; k += 16)
+            {
+                __m256i taps[5];
+                for (int d = 0; d < 5; ++d)
+                {
+                    taps[d] = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + k + d - 2)));
+                }
+                const __m256i(&coef)[2][3] = pairs[k % 3];
+
+                __m256i lo = _mm256_add_epi32(rounding, _mm256_madd_epi16(_mm256_unpacklo_epi16(taps[0], taps[1]), coef[0][0]));
+                lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(taps[2], taps[3]), coef[0][1]));
+                lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(taps[4], zero), coef[0][2]));
+                __m256i hi = _mm256_add_epi32(rounding, _mm256_madd_epi16(_mm256_unpackhi_epi16(taps[0], taps[1]), coef[1][0]));
+                hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(taps[2], taps[3]), coef[1][1]));
+                hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(taps[4], zero), coef[1][2]));
+
+                __m256i packed = _mm256_packs_epi32(_mm256_srai_epi32(lo, SimdKernels::SATURATION_SHIFT),
+                                                    _mm256_srai_epi32(hi, SimdKernels::SATURATION_SHIFT));
+                packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(packed, packed), 0x08);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + k), _mm256_castsi256_si128(packed));
+            }
+            saturationRowSse2(src, dst, k, total, coefficients);
+        }
+
+        // 从权重数组载入相邻两个 16 位权重，与 packWeightPair(w[0], w[1]) 相同
+        inline int loadWeightPair(const short *w)
+        {
+            int pair;
+            std::memcpy(&pair, w, sizeof(pair));
+            return pair;
+        }
+
+        // 载入一个 CN 通道像素到低 32 位并展开为 16 位（不读取像素之后的字节）
+        // 3 通道逐字节拼接：经栈上 3 字节拷贝再读 4 字节会导致存储转发失败
+        template <int CN>
+        inline __m128i loadPixel(const uchar *p, __m128i zero)
+        {
+            int value;
+            if (CN == 4)
+            {
+                std::memcpy(&value, p, sizeof(value));
+            }
+            else
+            {
+                value = p[0] | (p[1] << 8) | (p[2] << 16);
+            }
+            return _mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero);
+        }
+
+        // 多通道 SSE2 水平重采样：每次取两个相邻像素交错成 (p0, p1) 对，与权重对做 madd，
+        // 一个 128 位寄存器同时累加 4 个通道
+        template <int CN>
+        void resampleHorizontalPixelsSse2(const uchar *src, short *dst, int width, const int *starts,
+                                          const short *weights, int taps)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i rounding = _mm_set1_epi32(1 << (HORIZONTAL_SHIFT - 1));
+            for (int x = 0; x < width; ++x)
+            {
+                const uchar *pixels = src + starts[x] * CN;
+                const short *w = weights + static_cast<size_t>(x) * taps;
+                __m128i acc = rounding;
+                int k = 0;
+                for (; k + 2 <= taps; k += 2)
+                {
+                    // 第一个像素之后还有像素，可以直接读 4 字节（3 通道时第 4 个分量不使用）
+                    __m128i first = loadPixel<4>(pixels + k * CN, zero);
+                    __m128i pair = _mm_unpacklo_epi16(first, loadPixel<CN>(pixels + (k + 1) * CN, zero));
+                    acc = _mm_add_epi32(acc, _mm_madd_epi16(pair, _mm_set1_epi32(loadWeightPair(w + k))));
+                }
+                if (k < taps)
+                {
+                    __m128i pair = _mm_unpacklo_epi16(loadPixel<CN>(pixels + k * CN, zero), zero);
+                    acc = _mm_add_epi32(acc, _mm_madd_epi16(pair, _mm_set1_epi32(packWeightPair(w[k], 0))));
+                }
+                __m128i packed = _mm_packs_epi32(_mm_srai_epi32(acc, HORIZONTAL_SHIFT), zero);
+                short values[8];
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(values), packed);
+                std::memcpy(dst + x * CN, values, CN * sizeof(short));
+            }
+        }
+
+        // 单通道 SSE2 水平重采样：每次 8 个抽头做 madd，最后横向求和
+        void resampleHorizontalGraySse2(const uchar *src, short *dst, int width, const int *starts, const short *weights, int taps)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            for (int x = 0; x < width; ++x)
+            {
+                const uchar *pixels = src + starts[x];
+                const short *w = weights + static_cast<size_t>(x) * taps;
+                __m128i acc = zero;
+                int k = 0;
+                for (; k + 8 <= taps; k += 8)
+                {
+                    __m128i p = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(pixels + k)), zero);
+                    acc = _mm_add_epi32(acc, _mm_madd_epi16(p, _mm_loadu_si128(reinterpret_cast<const __m128i *>(w + k))));
+                }
+                acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+                acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+                int sum = _mm_cvtsi128_si32(acc) + (1 << (HORIZONTAL_SHIFT - 1));
+                for (; k < taps; ++k)
+                {
+                    sum += w[k] * pixels[k];
+                }
+                dst[x] = clampToShort(sum >> HORIZONTAL_SHIFT);
+            }
+        }
+
+        void resampleHorizontalSse2(const uchar *src, short *dst, int width, int channels, const int *starts,
+                                    const short *weights, int taps)
+        {
+            switch (channels)
+            {
+            case 1:
+                resampleHorizontalGraySse2(src, dst, width, starts, weights, taps);
+                break;
+            case 3:
+                resampleHorizontalPixelsSse2<3>(src, dst, width, starts, weights, taps);
+                break;
+            case 4:
+                resampleHorizontalPixelsSse2<4>(src, dst, width, starts, weights, taps);
+                break;
+            default:
+                resampleHorizontalScalar(src, dst, 0, width, channels, starts, weights, taps);
+                break;
+            }
+        }
+
+        // SSE2 垂直重采样：每次处理 8 个元素，两行交错后与权重对做 madd
+        void resampleVerticalSse2(const short *const *rows, const short *weights, int taps, uchar *dst, int begin, int count)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i rounding = _mm_set1_epi32(1 << (VERTICAL_SHIFT - 1));
+            int e = begin;
+            for (; e + 8 <= count; e += 8)
+            {
+                __m128i lo = rounding;
+                __m128i hi = rounding;
+                for (int k = 0; k < taps; k += 2)
+                {
+                    bool pair = k + 1 < taps;
+                    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[k] + e));
+                    __m128i b = pair ? _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[k + 1] + e)) : zero;
+                    __m128i w = _mm_set1_epi32(packWeightPair(weights[k], pair ? weights[k + 1] : 0));
+                    lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+                    hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+                }
+                __m128i packed = _mm_packs_epi32(_mm_srai_epi32(lo, VERTICAL_SHIFT), _mm_srai_epi32(hi, VERTICAL_SHIFT));
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + e), _mm_packus_epi16(packed, packed));
+            }
+            resampleVerticalScalar(rows, weights, taps, dst, e, count);
+        }
+
+        // SSE2 2x2 方框缩小：两行先按 16 位相加，单通道用 madd 合并相邻像素，4 通道合并相邻的 64 位半部；
+        // 3 通道的相邻像素跨越寄存器边界，使用标量实现
+        void halveRowSse2(const uchar *row0, const uchar *row1, uchar *dst, int width, int channels)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i two = _mm_set1_epi16(2);
+            int count = width * channels;
+            int e = 0;
+            if (channels == 1)
+            {
+                const __m128i ones = _mm_set1_epi16(1);
+                for (; e + 8 <= count; e += 8)
+                {
+                    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + 2 * e));
+                    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + 2 * e));
+                    __m128i lo = _mm_madd_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)), ones);
+                    __m128i hi = _mm_madd_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)), ones);
+                    __m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_packs_epi32(lo, hi), two), 2);
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + e), _mm_packus_epi16(sum, sum));
+                }
+            }
+            else if (channels == 4)
+            {
+                for (; e + 8 <= count; e += 8)
+                {
+                    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + 2 * e));
+                    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + 2 * e));
+                    __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+                    __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+                    __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+                    sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + e), _mm_packus_epi16(sum, sum));
+                }
+            }
+            halveRowScalar(row0, row1, dst, e / channels, width, channels);
+        }
+
+        // SSE2 整数倍方框缩小：按列累加 factor 行使用 16 位加法，横向分组求均值为标量
+        void boxReduceRowSse2(const uchar *const *rows, int factor, uchar *dst, int width, int channels)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            ushort sums[BOX_BLOCK_PIXELS * MAX_BOX_FACTOR * 4];
+            for (int begin = 0; begin < width; begin += BOX_BLOCK_PIXELS)
+            {
+                int end = std::min(width, begin + BOX_BLOCK_PIXELS);
+                int offset = begin * factor * channels;
+                int count = (end - begin) * factor * channels;
+                int i = 0;
+                for (; i + 16 <= count; i += 16)
+                {
+                    __m128i lo = zero;
+                    __m128i hi = zero;
+                    for (int r = 0; r < factor; ++r)
+                    {
+                        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[r] + offset + i));
+                        lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(v, zero));
+                        hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(v, zero));
+                    }
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(sums + i), lo);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(sums + i + 8), hi);
+                }
+                for (; i < count; ++i)
+                {
+                    int sum = 0;
+                    for (int r = 0; r < factor; ++r)
+                    {
+                        sum += rows[r][offset + i];
+                    }
+                    sums[i] = static_cast<ushort>(sum);
+                }
+                boxReduceColumnsAny(sums, dst, begin, end, channels, factor);
+            }
+        }
+
+        // AVX2 路径（含 SSSE3 字节重排）的整数倍像素复制：每次载入 k 个输入像素，用预先生成的重排表写出 k * factor 个像素，
+        // 3 通道每块 5 个像素，最后一次存储可能越过块尾，由下一块覆盖
+        IP_TARGET_AVX2 void replicateRowAvx2(const uchar *src, uchar *dst, int width, int channels, int factor)
+        {
+            int block = channels == 3 ? 5 : 16 / channels;
+            int block_bytes = block * channels * factor;
+            int pieces = (block_bytes + 15) / 16;
+            __m128i masks[MAX_SHUFFLE_FACTOR];
+            for (int p = 0; p < pieces; ++p)
+            {
+                alignas(16) signed char mask[16];
+                for (int b = 0; b < 16; ++b)
+                {
+                    int j = p * 16 + b;
+                    int source = (j / channels / factor) * channels + j % channels;
+                    mask[b] = static_cast<signed char>(source < 16 ? source : -1);
+                }
+                masks[p] = _mm_load_si128(reinterpret_cast<const __m128i *>(mask));
+            }
+
+            int total_in = width * channels;
+            int total_out = total_in * factor;
+            int x = 0;
+            for (; x + block <= width && x * channels + 16 <= total_in && x * channels * factor + pieces * 16 <= total_out; x += block)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * channels));
+                uchar *out = dst + x * channels * factor;
+                for (int p = 0; p < pieces; ++p)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16 * p), _mm_shuffle_epi8(v, masks[p]));
+                }
+            }
+            replicateRangeScalar(src, dst, x, width, channels, factor);
+        }
+
+        // AVX2 水平重采样：单通道每次 16 个抽头；多通道每个像素只占 4 个 32 位累加器，沿用 SSE2 实现
+        IP_TARGET_AVX2 void resampleHorizontalAvx2(const uchar *src, short *dst, int width, int channels, const int *starts,
+                                                   const short *weights, int taps)
+        {
+            if (channels != 1 || taps < 16)
+            {
+                resampleHorizontalSse2(src, dst, width, channels, starts, weights, taps);
+                return;
+            }
+
+            for (int x = 0; x < width; ++x)
+            {
+                const uchar *pixels = src + starts[x];
+                const short *w = weights + static_cast<size_t>(x) * taps;
+                __m256i acc = _mm256_setzero_si256();
+                int k = 0;
+                for (; k + 16 <= taps; k += 16)
+                {
+                    __m256i p = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + k)));
+                    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(p, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + k))));
+                }
+                __m128i sum4 = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+                sum4 = _mm_add_epi32(sum4, _mm_shuffle_epi32(sum4, _MM_SHUFFLE(1, 0, 3, 2)));
+                sum4 = _mm_add_epi32(sum4, _mm_shuffle_epi32(sum4, _MM_SHUFFLE(2, 3, 0, 1)));
+                int sum = _mm_cvtsi128_si32(sum4) + (1 << (HORIZONTAL_SHIFT - 1));
+                for (; k < taps; ++k)
+                {
+                    sum += w[k] * pixels[k];
+                }
+                dst[x] = clampToShort(sum >> HORIZONTAL_SHIFT);
+            }
+        }
+
+        // AVX2 垂直重采样：每次处理 16 个元素；unpack 与 packs 都按 128 位通道进行，两次交错相互抵消，
+        // 最后用置换把两个通道的 8 个字节拼在一起
+        IP_TARGET_AVX2 void resampleVerticalAvx2(const short *const *rows, const short *weights, int taps, uchar *dst, int count)
+        {
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i rounding = _mm256_set1_epi32(1 << (VERTICAL_SHIFT - 1));
+            int e = 0;
+            for (; e + 16 <= count; e += 16)
+            {
+                __m256i lo = rounding;
+                __m256i hi = rounding;
+                for (int k = 0; k < taps; k += 2)
+                {
+                    bool pair = k + 1 < taps;
+                    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rows[k] + e));
+                    __m256i b = pair ? _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rows[k + 1] + e)) : zero;
+                    __m256i w = _mm256_set1_epi32(packWeightPair(weights[k], pair ? weights[k + 1] : 0));
+                    lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), w));
+                    hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), w));
+                }
+                __m256i packed = _mm256_packs_epi32(_mm256_srai_epi32(lo, VERTICAL_SHIFT), _mm256_srai_epi32(hi, VERTICAL_SHIFT));
+                packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(packed, packed), 0x08);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + e), _mm256_castsi256_si128(packed));
+            }
+            resampleVerticalSse2(rows, weights, taps, dst, e, count);
+        }
+#endif
+    }
+
+    bool SimdKernels::toFixedPointWeights(double weight_r, double weight_g, double weight_b, FixedPointWeights &weights)
+    {
+        const double scale = static_cast<double>(1 << GRAY_WEIGHT_SHIFT);
+        double scaled[3] = {weight_b * scale, weight_g * scale, weight_r * scale};
+        for (double value : scaled)
+        {
+            // SIMD 内核使用 16 位乘法，权重必须落在 int16 范围内
+            if (std::fabs(value) >= 32767.0)
+            {
+                return false;
+            }
+        }
+
+        int fixed[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            fixed[i] = static_cast<int>(std::lround(scaled[i]));
+        }
+
+        // 把舍入误差补到绝对值最大的权重上，使纯白仍然映射到 255
+        int target = static_cast<int>(std::lround(scaled[0] + scaled[1] + scaled[2]));
+        int largest = 0;
+        for (int i = 1; i < 3; ++i)
+        {
+            if (std::abs(fixed[i]) > std::abs(fixed[largest]))
+            {
+                largest = i;
+            }
+        }
+        fixed[largest] += target - (fixed[0] + fixed[1] + fixed[2]);
+        if (std::abs(fixed[largest]) >= 32767)
+        {
+            return false;
+        }
+
+        weights.b = fixed[0];
+        weights.g = fixed[1];
+        weights.r = fixed[2];
+        return true;
+    }
+
+    void SimdKernels::makeSaturationCoefficients(double factor, SaturationCoefficients &coefficients)
+    {
+        // BGR 顺序的亮度权重（BT.601）
+        static const double luma_weights[3] = {0.114, 0.587, 0.299};
+
+        // 系数需落在 int16 范围内，饱和度系数限制在 [0, 3]
+        factor = std::min(3.0, std::max(0.0, factor));
+        const double scale = static_cast<double>(1 << SATURATION_SHIFT);
+        for (int channel = 0; channel < 3; ++channel)
+        {
+            for (int d = 0; d < 5; ++d)
+            {
+                int source = channel + d - 2;
+                double tap = 0.0;
+                if (source >= 0 && source < 3)
+                {
+                    tap = (1.0 - factor) * luma_weights[source] + (source == channel ? factor : 0.0);
+                }
+                coefficients.taps[channel][d] = static_cast<int>(std::lround(tap * scale));
+            }
+        }
+    }
+
+    void SimdKernels::saturationRow(const uchar *src, uchar *dst, int width, const SaturationCoefficients &coefficients)
+    {
+        switch (instructionSet())
+        {
+#ifdef IP_SIMD_X86
+        case InstructionSet::AVX2:
+            saturationRowAvx2(src, dst, 0, 3 * width, coefficients);
+            break;
+        case InstructionSet::SSE2:
+            saturationRowSse2(src, dst, 0, 3 * width, coefficients);
+            break;
+#endif
+        default:
+            saturationRangeScalar(src, dst, 0, 3 * width, coefficients);
+            break;
+        }
+    }
+
+    void SimdKernels::weightedGrayRow(const uchar *src, uchar *dst, int width, const FixedPointWeights &weights)
+    {
+        switch (instructionSet())
+        {
+#ifdef IP_SIMD_X86
+        case InstructionSet::AVX2:
+            weightedGrayRowAvx2(src, dst, width, weights);
+            break;
+        case InstructionSet::SSE2:
+            weightedGrayRowSse2(src, dst, width, weights);
+            break;
+#endif
+        default:
+            weightedGrayRowScalar(src, dst, width, weights);
+            break;
+        }
+    }
+
+    void SimdKernels::resampleHorizontalRow(const uchar *src, short *dst, int width, int channels, const int *starts,
+                                            const short *weights, int taps)
+    {
+        switch (instructionSet())
+        {
+#ifdef IP_SIMD_X86
+        case InstructionSet::AVX2:
+            resampleHorizontalAvx2(src, dst, width, channels, starts, weights, taps);
+            break;
+        case InstructionSet::SSE2:
+            resampleHorizontalSse2(src, dst, width, channels, starts, weights, taps);
+            break;
+#endif
+        default:
+            resampleHorizontalScalar(src, dst, 0, width, channels, starts, weights, taps);
+            break;
+        }
+    }
+
+    void SimdKernels::resampleVerticalRow(const short *const *rows, const short *weights, int taps, uchar *dst, int count)
+    {
+        switch (instructionSet())
+        {
+#ifdef IP_SIMD_X86
+        case InstructionSet::AVX2:
+            resampleVerticalAvx2(rows, weights, taps, dst, count);
+            break;
+        case InstructionSet::SSE2:
+            resampleVerticalSse2(rows, weights, taps, dst, 0, count);
+            break;
+#endif
+        default:
+            resampleVerticalScalar(rows, weights, taps, dst, 0, count);
+            break;
+        }
+    }
+
+    void SimdKernels::halveRow(const uchar *row0, const uchar *row1, uchar *dst, int width, int channels)
+    {
+        switch (instructionSet())
+        {
+#ifdef IP_SIMD_X86
+        case InstructionSet::AVX2:
+        case InstructionSet::SSE2:
+            halveRowSse2(row0, row1, dst, width, channels);
+            break;
+#endif
+        default:
+            halveRowScalar(row0, row1, dst, 0, width, channels);
+            break;
+        }
+    }
+
+    void SimdKernels::replicateRow(const uchar *src, uchar *dst, int width, int channels, int factor)
+    {
+        switch (instructionSet())
+        {
+#ifdef IP_SIMD_X86
+        case InstructionSet::AVX2:
+            if (factor <= MAX_SHUFFLE_FACTOR)
+            {
+                replicateRowAvx2(src, dst, width, channels, factor);
+                break;
+            }
+            replicateRangeScalar(src, dst, 0, width, channels, factor);
+            break;
+#endif
+        default:
+            replicateRangeScalar(src, dst, 0, width, channels, factor);
+            break;
+        }
+    }
+
+    void SimdKernels::boxReduceRow(const uchar *const *rows, int factor, uchar *dst, int width, int channels)
+    {
+        if (factor == 2)
+        {
+            halveRow(rows[0], rows[1], dst, width, channels);
+            return;
+        }
+
+        switch (instructionSet())
+        {
+#ifdef IP_SIMD_X86
+        case InstructionSet::AVX2:
+        case InstructionSet::SSE2:
+            boxReduceRowSse2(rows, factor, dst, width, channels);
+            break;
+#endif
+        default:
+            boxReduceRowScalar(rows, factor, dst, width, channels);
+            break;
+        }
+    }
+
+    std::string SimdKernels::activeInstructionSet()
+    {
+        switch (instructionSet())
+        {
+        case InstructionSet::AVX2:
+            return "AVX2";
+        case InstructionSet::SSE2:
+            return "SSE2";
+        default:
+            return "scalar";
+        }
+    }
+
+} // namespace image_processor
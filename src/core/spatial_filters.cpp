@@ -0,0 +1,631 @@
+#include "spatial_filters.hpp"
+#include "logger.hpp"
+#include "parallel.hpp"
+#include "pixel_kernels.hpp"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace image_processor
+{
+
+    namespace
+    {
+        // 参数上限
+        const int MAX_BLUR_RADIUS = 1000;
+        const double MAX_SIGMA = 500.0;
+        const double MAX_SHARPEN_AMOUNT = 10.0;
+
+        // sigma 不小于该值时高斯模糊改用递归滤波（可分离卷积的核长约为 6 * sigma）
+        const double RECURSIVE_MIN_SIGMA = 3.0;
+
+        // 检查图像是否为空以及格式是否受支持，不满足时输出错误日志
+        bool checkImage(const cv::Mat &image, const std::string &operation)
+        {
+            if (image.empty())
+            {
+                Logger::log(LogLevel::IP_LOGLV_ERROR, "Cannot apply " + operation + " to empty image");
+                return false;
+            }
+
+            int depth = image.depth();
+            int channels = image.channels();
+            if ((depth == CV_8U || depth == CV_16U || depth == CV_32F) && (channels == 1 || channels == 3 || channels == 4))
+            {
+                return true;
+            }
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Unsupported image format for " + operation);
+            return false;
+        }
+
+        inline int clampIndex(int index, int size)
+        {
+            return std::min(std::max(index, 0), size - 1);
+        }
+
+        // 行方向滑动窗口和：每个像素的窗口和由前一个像素的窗口和加上进入窗口的像素、减去离开窗口的像素得到
+        // 累加使用 double，16 位和浮点图像也不会随着滑动积累误差
+        template <typename T, int CN>
+        void boxSumRow(const T *src, float *dst, int width, int radius)
+        {
+            double sum[CN];
+            for (int c = 0; c < CN; ++c)
+            {
+                sum[c] = 0.0;
+                for (int k = -radius; k <= radius; ++k)
+                {
+                    sum[c] += src[clampIndex(k, width) * CN + c];
+                }
+                dst[c] = static_cast<float>(sum[c]);
+            }
+
+            for (int x = 1; x < width; ++x)
+            {
+                const T *enter = src + std::min(x + radius, width - 1) * CN;
+                const T *leave = src + std::max(x - radius - 1, 0) * CN;
+                for (int c = 0; c < CN; ++c)
+                {
+                    sum[c] += static_cast<double>(enter[c]) - leave[c];
+                    dst[x * CN + c] = static_cast<float>(sum[c]);
+                }
+            }
+        }
+
+        // 列方向滑动窗口：在一个列块内自上而下扫描，窗口和保存为一行累加器，
+        // 每一行只加上进入窗口的行、减去离开窗口的行，内层循环沿连续内存可以向量化
+        template <typename T>
+        void boxSumColumns(const cv::Mat &sums, cv::Mat &dst, int first, int last, int radius, double scale)
+        {
+            int rows = sums.rows;
+            int count = last - first;
+            std::vector<double> sum(count, 0.0);
+            for (int k = -radius; k <= radius; ++k)
+            {
+                const float *row = sums.ptr<float>(clampIndex(k, rows)) + first;
+                for (int e = 0; e < count; ++e)
+                {
+                    sum[e] += row[e];
+                }
+            }
+
+            for (int i = 0; i < rows; ++i)
+            {
+                int enter = std::min(i + radius, rows - 1);
+                int leave = std::max(i - radius - 1, 0);
+                if (i > 0 && enter != leave)
+                {
+                    const float *enter_row = sums.ptr<float>(enter) + first;
+                    const float *leave_row = sums.ptr<float>(leave) + first;
+                    for (int e = 0; e < count; ++e)
+                    {
+                        sum[e] += static_cast<double>(enter_row[e]) - leave_row[e];
+                    }
+                }
+
+                T *out = dst.ptr<T>(i) + first;
+                for (int e = 0; e < count; ++e)
+                {
+                    out[e] = cv::saturate_cast<T>(sum[e] * scale);
+                }
+            }
+        }
+
+        // 导向滤波第一步的行方向：一次读取同时累加 I 和 I * I 的窗口和
+        // 8 位图像使用整数累加（窗口和精确且不需要类型转换），其余深度使用 double
+        template <typename T, int CN>
+        void guidedSumsRow(const T *src, float *sum_i, float *sum_ii, int width, int radius)
+        {
+            typedef typename std::conditional<std::is_same<T, uchar>::value, int, double>::type Accumulator;
+            Accumulator s[CN], ss[CN];
+            for (int c = 0; c < CN; ++c)
+            {
+                s[c] = ss[c] = 0;
+                for (int k = -radius; k <= radius; ++k)
+                {
+                    Accumulator value = src[clampIndex(k, width) * CN + c];
+                    s[c] += value;
+                    ss[c] += value * value;
+                }
+                sum_i[c] = static_cast<float>(s[c]);
+                sum_ii[c] = static_cast<float>(ss[c]);
+            }
+
+            for (int x = 1; x < width; ++x)
+            {
+                const T *enter = src + std::min(x + radius, width - 1) * CN;
+                const T *leave = src + std::max(x - radius - 1, 0) * CN;
+                for (int c = 0; c < CN; ++c)
+                {
+                    Accumulator in = enter[c];
+                    Accumulator out = leave[c];
+                    s[c] += in - out;
+                    ss[c] += in * in - out * out;
+                    sum_i[x * CN + c] = static_cast<float>(s[c]);
+                    sum_ii[x * CN + c] = static_cast<float>(ss[c]);
+                }
+            }
+        }
+
+        // 导向滤波第一步的列方向：由窗口均值和方差求出线性系数 a = var / (var + eps)、b = mean * (1 - a)
+        // 系数写回两个窗口和缓冲区；某一行在滑出窗口之前仍会被读取，因此先暂存在环形缓冲区中，
+        // 等该行不再被读取后再写回，整个滤波只需要两张浮点中间图像
+        void guidedCoefficientColumns(cv::Mat &sum_i, cv::Mat &sum_ii, int first, int last, int radius, double eps)
+        {
+            int rows = sum_i.rows;
+            int count = last - first;
+            double scale = 1.0 / ((2.0 * radius + 1.0) * (2.0 * radius + 1.0));
+            std::vector<double> s(count, 0.0), ss(count, 0.0);
+            for (int k = -radius; k <= radius; ++k)
+            {
+                const float *row_i = sum_i.ptr<float>(clampIndex(k, rows)) + first;
+                const float *row_ii = sum_ii.ptr<float>(clampIndex(k, rows)) + first;
+                for (int e = 0; e < count; ++e)
+                {
+                    s[e] += row_i[e];
+                    ss[e] += row_ii[e];
+                }
+            }
+
+            int ring_rows = radius + 2;
+            std::vector<float> ring_a(static_cast<size_t>(ring_rows) * count);
+            std::vector<float> ring_b(static_cast<size_t>(ring_rows) * count);
+            auto flush = [&](int row)
+            {
+                size_t offset = static_cast<size_t>(row % ring_rows) * count;
+                std::copy(ring_a.begin() + offset, ring_a.begin() + offset + count, sum_i.ptr<float>(row) + first);
+                std::copy(ring_b.begin() + offset, ring_b.begin() + offset + count, sum_ii.ptr<float>(row) + first);
+            };
+
+            for (int i = 0; i < rows; ++i)
+            {
+                int enter = std::min(i + radius, rows - 1);
+                int leave = std::max(i - radius - 1, 0);
+                if (i > 0 && enter != leave)
+                {
+                    const float *enter_i = sum_i.ptr<float>(enter) + first;
+                    const float *enter_ii = sum_ii.ptr<float>(enter) + first;
+                    const float *leave_i = sum_i.ptr<float>(leave) + first;
+                    const float *leave_ii = sum_ii.ptr<float>(leave) + first;
+                    for (int e = 0; e < count; ++e)
+                    {
+                        s[e] += static_cast<double>(enter_i[e]) - leave_i[e];
+                        ss[e] += static_cast<double>(enter_ii[e]) - leave_ii[e];
+                    }
+                }
+
+                float *a = ring_a.data() + static_cast<size_t>(i % ring_rows) * count;
+                float *b = ring_b.data() + static_cast<size_t>(i % ring_rows) * count;
+                for (int e = 0; e < count; ++e)
+                {
+                    double mean = s[e] * scale;
+                    double variance = std::max(ss[e] * scale - mean * mean, 0.0);
+                    double gain = variance / (variance + eps);
+                    a[e] = static_cast<float>(gain);
+                    b[e] = static_cast<float>(mean * (1.0 - gain));
+                }
+
+                // 第 i - radius - 1 行已经滑出窗口，之后不会再被读取
+                if (i - radius - 1 >= 0)
+                {
+                    flush(i - radius - 1);
+                }
+            }
+            for (int row = std::max(rows - radius - 1, 0); row < rows; ++row)
+            {
+                flush(row);
+            }
+        }
+
+        // 导向滤波第二步的列方向：对系数求窗口均值后输出 q = mean_a * I + mean_b
+        template <typename T, int CN>
+        void guidedOutputColumns(const cv::Mat &sum_a, const cv::Mat &sum_b, const cv::Mat &src, cv::Mat &dst,
+                                 int first, int last, int radius)
+        {
+            int rows = sum_a.rows;
+            int count = last - first;
+            double scale = 1.0 / ((2.0 * radius + 1.0) * (2.0 * radius + 1.0));
+            std::vector<double> sa(count, 0.0), sb(count, 0.0);
+            for (int k = -radius; k <= radius; ++k)
+            {
+                const float *row_a = sum_a.ptr<float>(clampIndex(k, rows)) + first;
+                const float *row_b = sum_b.ptr<float>(clampIndex(k, rows)) + first;
+                for (int e = 0; e < count; ++e)
+                {
+                    sa[e] += row_a[e];
+                    sb[e] += row_b[e];
+                }
+            }
+
+            for (int i = 0; i < rows; ++i)
+            {
+                int enter = std::min(i + radius, rows - 1);
+                int leave = std::max(i - radius - 1, 0);
+                if (i > 0 && enter != leave)
+                {
+                    const float *enter_a = sum_a.ptr<float>(enter) + first;
+                    const float *enter_b = sum_b.ptr<float>(enter) + first;
+                    const float *leave_a = sum_a.ptr<float>(leave) + first;
+                    const float *leave_b = sum_b.ptr<float>(leave) + first;
+                    for (int e = 0; e < count; ++e)
+                    {
+                        sa[e] += static_cast<double>(enter_a[e]) - leave_a[e];
+                        sb[e] += static_cast<double>(enter_b[e]) - leave_b[e];
+                    }
+                }
+
+                const T *in = src.ptr<T>(i) + first;
+                T *out = dst.ptr<T>(i) + first;
+                if (CN == 4)
+                {
+                    // Alpha 通道原样保留（原地处理时 in 与 out 相同，不能先整行写出再恢复）
+                    for (int e = 0; e < count; e += 4)
+                    {
+                        for (int c = 0; c < 3; ++c)
+                        {
+                            out[e + c] = cv::saturate_cast<T>((sa[e + c] * in[e + c] + sb[e + c]) * scale);
+                        }
+                        out[e + 3] = in[e + 3];
+                    }
+                    continue;
+                }
+                for (int e = 0; e < count; ++e)
+                {
+                    out[e] = cv::saturate_cast<T>((sa[e] * in[e] + sb[e]) * scale);
+                }
+            }
+        }
+
+        // Young & van Vliet 三阶递归高斯滤波：w[n] = b * x[n] + a1 * w[n-1] + a2 * w[n-2] + a3 * w[n-3]，
+        // 正向和反向各递推一次得到近似的高斯响应，每个像素的计算量与 sigma 无关
+        struct RecursiveGaussian
+        {
+            double b;
+            double a1;
+            double a2;
+            double a3;
+
+            explicit RecursiveGaussian(double sigma)
+            {
+                double q = sigma >= 2.5 ? 0.98711 * sigma - 0.96330 : 3.97156 - 4.14554 * std::sqrt(1.0 - 0.26891 * sigma);
+                double q2 = q * q;
+                double q3 = q2 * q;
+                double b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 + 0.422205 * q3;
+                a1 = (2.44413 * q + 2.85619 * q2 + 1.26661 * q3) / b0;
+                a2 = -(1.4281 * q2 + 1.26661 * q3) / b0;
+                a3 = 0.422205 * q3 / b0;
+                b = 1.0 - (a1 + a2 + a3);
+            }
+        };
+
+        // 行方向递推：边界外取边缘像素的稳态值，即递推状态初始化为第一个（反向时为最后一个）值
+        template <typename T, int CN>
+        void recursiveRow(const T *src, float *dst, int width, const RecursiveGaussian &g)
+        {
+            double w1[CN], w2[CN], w3[CN];
+            for (int c = 0; c < CN; ++c)
+            {
+                w1[c] = w2[c] = w3[c] = src[c];
+            }
+            for (int x = 0; x < width; ++x)
+            {
+                for (int c = 0; c < CN; ++c)
+                {
+                    double w = g.b * src[x * CN + c] + g.a1 * w1[c] + g.a2 * w2[c] + g.a3 * w3[c];
+                    w3[c] = w2[c], w2[c] = w1[c], w1[c] = w;
+                    dst[x * CN + c] = static_cast<float>(w);
+                }
+            }
+
+            for (int c = 0; c < CN; ++c)
+            {
+                w1[c] = w2[c] = w3[c] = dst[(width - 1) * CN + c];
+            }
+            for (int x = width - 1; x >= 0; --x)
+            {
+                for (int c = 0; c < CN; ++c)
+                {
+                    double w = g.b * dst[x * CN + c] + g.a1 * w1[c] + g.a2 * w2[c] + g.a3 * w3[c];
+                    w3[c] = w2[c], w2[c] = w1[c], w1[c] = w;
+                    dst[x * CN + c] = static_cast<float>(w);
+                }
+            }
+        }
+
+        // 列方向递推：在一个列块内原地更新中间结果，前三行的状态就是缓冲区中已经更新的行，
+        // 内层循环沿连续内存可以向量化；反向递推的同时写出结果
+        template <typename T>
+        void recursiveColumns(cv::Mat &buffer, cv::Mat &dst, int first, int last, const RecursiveGaussian &g)
+        {
+            int rows = buffer.rows;
+            int count = last - first;
+            float b = static_cast<float>(g.b);
+            float a1 = static_cast<float>(g.a1);
+            float a2 = static_cast<float>(g.a2);
+            float a3 = static_cast<float>(g.a3);
+
+            std::vector<float> edge(buffer.ptr<float>(0) + first, buffer.ptr<float>(0) + last);
+            const float *p1 = edge.data(), *p2 = edge.data(), *p3 = edge.data();
+            for (int i = 0; i < rows; ++i)
+            {
+                float *row = buffer.ptr<float>(i) + first;
+                for (int e = 0; e < count; ++e)
+                {
+                    row[e] = b * row[e] + a1 * p1[e] + a2 * p2[e] + a3 * p3[e];
+                }
+                p3 = p2, p2 = p1, p1 = row;
+            }
+
+            edge.assign(buffer.ptr<float>(rows - 1) + first, buffer.ptr<float>(rows - 1) + last);
+            p1 = p2 = p3 = edge.data();
+            for (int i = rows - 1; i >= 0; --i)
+            {
+                float *row = buffer.ptr<float>(i) + first;
+                T *out = dst.ptr<T>(i) + first;
+                for (int e = 0; e < count; ++e)
+                {
+                    row[e] = b * row[e] + a1 * p1[e] + a2 * p2[e] + a3 * p3[e];
+                    out[e] = cv::saturate_cast<T>(row[e]);
+                }
+                p3 = p2, p2 = p1, p1 = row;
+            }
+        }
+
+        // 由模糊结果锐化：out = src + amount * (src - blurred)，差值小于 limit 的像素保持不变
+        // BGRA 图像的 Alpha 通道原样保留；dst 可以与 src 或 blurred 为同一图像
+        void sharpenFromBlur(const cv::Mat &src, const cv::Mat &blurred, cv::Mat &dst, double amount, double limit)
+        {
+            cv::Mat input = src;
+            dst.create(input.rows, input.cols, input.type());
+            PixelKernels::dispatch(input.depth(), input.channels(), [&](auto format)
+                                   {
+                typedef typename decltype(format)::value_type T;
+                constexpr int CN = decltype(format)::channels;
+                constexpr int COLOR_CN = CN == 4 ? 3 : CN;
+                float gain = static_cast<float>(amount);
+                float threshold = static_cast<float>(limit);
+                Parallel::forEachRowBand(input, [&](const cv::Range &rows)
+                                         {
+                    for (int i = rows.start; i < rows.end; ++i)
+                    {
+                        const T *src_row = input.ptr<T>(i);
+                        const T *blur_row = blurred.ptr<T>(i);
+                        T *dst_row = dst.ptr<T>(i);
+                        for (int j = 0; j < input.cols; ++j)
+                        {
+                            for (int c = 0; c < COLOR_CN; ++c)
+                            {
+                                float value = src_row[j * CN + c];
+                                float diff = value - blur_row[j * CN + c];
+                                dst_row[j * CN + c] = std::abs(diff) < threshold ? src_row[j * CN + c]
+                                                                                 : cv::saturate_cast<T>(value + gain * diff);
+                            }
+                            if (CN == 4)
+                            {
+                                dst_row[j * CN + 3] = src_row[j * CN + 3];
+                            }
+                        }
+                    } }); });
+        }
+    }
+
+    cv::Mat SpatialFilters::boxBlur(const cv::Mat &image, int radius)
+    {
+        cv::Mat result;
+        return boxBlur(image, result, radius) ? result : cv::Mat();
+    }
+
+    bool SpatialFilters::boxBlur(const cv::Mat &image, cv::Mat &dst, int radius)
+    {
+        if (!checkImage(image, "box blur"))
+        {
+            return false;
+        }
+
+        if (radius < 1 || radius > MAX_BLUR_RADIUS)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Blur radius must be between 1 and " + std::to_string(MAX_BLUR_RADIUS));
+            return false;
+        }
+
+        // 行方向的窗口和写入浮点中间结果（8 位图像的窗口和在浮点数中是精确的），之后不再读取原图，
+        // 因此 dst 可以直接与原图共用内存
+        cv::Mat input = image;
+        cv::Mat sums(input.rows, input.cols, CV_32FC(input.channels()));
+        double scale = 1.0 / ((2.0 * radius + 1.0) * (2.0 * radius + 1.0));
+        PixelKernels::dispatch(input.depth(), input.channels(), [&](auto format)
+                               {
+            typedef typename decltype(format)::value_type T;
+            constexpr int CN = decltype(format)::channels;
+            Parallel::forEachRowBand(input, [&](const cv::Range &rows)
+                                     {
+                for (int i = rows.start; i < rows.end; ++i)
+                {
+                    boxSumRow<T, CN>(input.ptr<T>(i), sums.ptr<float>(i), input.cols, radius);
+                } });
+
+            dst.create(input.rows, input.cols, input.type());
+            Parallel::forEachColumnBand(input, [&](const cv::Range &cols)
+                                        { boxSumColumns<T>(sums, dst, cols.start * CN, cols.end * CN, radius, scale); }); });
+
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Box blur applied with radius " + std::to_string(radius));
+        return true;
+    }
+
+    cv::Mat SpatialFilters::gaussianBlur(const cv::Mat &image, double sigma)
+    {
+        cv::Mat result;
+        return gaussianBlur(image, result, sigma) ? result : cv::Mat();
+    }
+
+    bool SpatialFilters::gaussianBlur(const cv::Mat &image, cv::Mat &dst, double sigma)
+    {
+        if (!checkImage(image, "gaussian blur"))
+        {
+            return false;
+        }
+
+        if (!(sigma > 0.0 && sigma <= MAX_SIGMA))
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Gaussian sigma must be between 0 and " + std::to_string(static_cast<int>(MAX_SIGMA)));
+            return false;
+        }
+
+        if (sigma < RECURSIVE_MIN_SIGMA)
+        {
+            cv::GaussianBlur(image, dst, cv::Size(), sigma, sigma, cv::BORDER_REPLICATE);
+            Logger::log(LogLevel::IP_LOGLV_INFO, "Gaussian blur applied with sigma " + std::to_string(sigma));
+            return true;
+        }
+
+        // 行方向递推的结果写入浮点中间结果，列方向在其上原地递推后写出
+        cv::Mat input = image;
+        cv::Mat buffer(input.rows, input.cols, CV_32FC(input.channels()));
+        RecursiveGaussian coefficients(sigma);
+        PixelKernels::dispatch(input.depth(), input.channels(), [&](auto format)
+                               {
+            typedef typename decltype(format)::value_type T;
+            constexpr int CN = decltype(format)::channels;
+            Parallel::forEachRowBand(input, [&](const cv::Range &rows)
+                                     {
+                for (int i = rows.start; i < rows.end; ++i)
+                {
+                    recursiveRow<T, CN>(input.ptr<T>(i), buffer.ptr<float>(i), input.cols, coefficients);
+                } });
+
+            dst.create(input.rows, input.cols, input.type());
+            Parallel::forEachColumnBand(input, [&](const cv::Range &cols)
+                                        { recursiveColumns<T>(buffer, dst, cols.start * CN, cols.end * CN, coefficients); }); });
+
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Recursive gaussian blur applied with sigma " + std::to_string(sigma));
+        return true;
+    }
+
+    cv::Mat SpatialFilters::unsharpMask(const cv::Mat &image, double radius, double amount, double threshold)
+    {
+        cv::Mat result;
+        return unsharpMask(image, result, radius, amount, threshold) ? result : cv::Mat();
+    }
+
+    bool SpatialFilters::unsharpMask(const cv::Mat &image, cv::Mat &dst, double radius, double amount, double threshold)
+    {
+        if (!(amount >= 0.0 && amount <= MAX_SHARPEN_AMOUNT))
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Sharpen amount must be between 0 and " + std::to_string(static_cast<int>(MAX_SHARPEN_AMOUNT)));
+            return false;
+        }
+
+        if (!(threshold >= 0.0 && threshold <= 255.0))
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Unsharp mask threshold must be between 0 and 255");
+            return false;
+        }
+
+        cv::Mat blurred;
+        if (!gaussianBlur(image, blurred, radius))
+        {
+            return false;
+        }
+
+        sharpenFromBlur(image, blurred, dst, amount, threshold / 255.0 * PixelKernels::maxValue(image.depth()));
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Unsharp mask applied with radius " + std::to_string(radius) +
+                                                 ", amount " + std::to_string(amount));
+        return true;
+    }
+
+    cv::Mat SpatialFilters::sharpen(const cv::Mat &image, double amount)
+    {
+        cv::Mat result;
+        return sharpen(image, result, amount) ? result : cv::Mat();
+    }
+
+    bool SpatialFilters::sharpen(const cv::Mat &image, cv::Mat &dst, double amount)
+    {
+        if (!(amount >= 0.0 && amount <= MAX_SHARPEN_AMOUNT))
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Sharpen amount must be between 0 and " + std::to_string(static_cast<int>(MAX_SHARPEN_AMOUNT)));
+            return false;
+        }
+
+        cv::Mat blurred;
+        if (!boxBlur(image, blurred, 1))
+        {
+            return false;
+        }
+
+        sharpenFromBlur(image, blurred, dst, amount, 0.0);
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Sharpen applied with amount " + std::to_string(amount));
+        return true;
+    }
+
+    cv::Mat SpatialFilters::guidedFilter(const cv::Mat &image, int radius, double eps)
+    {
+        cv::Mat result;
+        return guidedFilter(image, result, radius, eps) ? result : cv::Mat();
+    }
+
+    bool SpatialFilters::guidedFilter(const cv::Mat &image, cv::Mat &dst, int radius, double eps)
+    {
+        if (!checkImage(image, "guided filter"))
+        {
+            return false;
+        }
+
+        if (radius < 1 || radius > MAX_BLUR_RADIUS)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Guided filter radius must be between 1 and " + std::to_string(MAX_BLUR_RADIUS));
+            return false;
+        }
+
+        if (!(eps > 0.0 && eps <= 1.0))
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Guided filter eps must be between 0 and 1");
+            return false;
+        }
+
+        // 所有通道交错在同一次遍历中处理；窗口统计以图像自身的取值范围为单位，eps 随之换算
+        cv::Mat input = image;
+        double max_value = PixelKernels::maxValue(input.depth());
+        double scaled_eps = eps * max_value * max_value;
+        cv::Mat first(input.rows, input.cols, CV_32FC(input.channels()));
+        cv::Mat second(input.rows, input.cols, CV_32FC(input.channels()));
+        PixelKernels::dispatch(input.depth(), input.channels(), [&](auto format)
+                               {
+            typedef typename decltype(format)::value_type T;
+            constexpr int CN = decltype(format)::channels;
+
+            // 第一步：I 和 I * I 的窗口和 -> 系数 a、b（分别写回 first、second）
+            Parallel::forEachRowBand(input, [&](const cv::Range &rows)
+                                     {
+                for (int i = rows.start; i < rows.end; ++i)
+                {
+                    guidedSumsRow<T, CN>(input.ptr<T>(i), first.ptr<float>(i), second.ptr<float>(i), input.cols, radius);
+                } });
+            Parallel::forEachColumnBand(input, [&](const cv::Range &cols)
+                                        { guidedCoefficientColumns(first, second, cols.start * CN, cols.end * CN, radius, scaled_eps); });
+
+            // 第二步：a、b 的窗口和（每行先复制出来再原地写回）-> 输出
+            Parallel::forEachRowBand(input, [&](const cv::Range &rows)
+                                     {
+                std::vector<float> line(static_cast<size_t>(input.cols) * CN);
+                for (int i = rows.start; i < rows.end; ++i)
+                {
+                    for (cv::Mat *plane : {&first, &second})
+                    {
+                        float *row = plane->ptr<float>(i);
+                        std::copy(row, row + line.size(), line.begin());
+                        boxSumRow<float, CN>(line.data(), row, input.cols, radius);
+                    }
+                } });
+            dst.create(input.rows, input.cols, input.type());
+            Parallel::forEachColumnBand(input, [&](const cv::Range &cols)
+                                        { guidedOutputColumns<T, CN>(first, second, input, dst, cols.start * CN, cols.end * CN, radius); }); });
+
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Guided filter applied with radius " + std::to_string(radius) +
+                                                 ", eps " + std::to_string(eps));
+        return true;
+    }
+
+} // namespace image_processor
@@ -0,0 +1,146 @@
+#include "tiled_executor.hpp"
+#include "image_scaling.hpp"
+#include "resampler.hpp"
+#include "parallel.hpp"
+#include "logger.hpp"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <numeric>
+#include <string>
+
+namespace image_processor
+{
+
+    // 默认约 1600 万像素以上的图像才分块执行，小图像整图处理已经足够快
+    std::atomic<size_t> TiledExecutor::min_tiled_pixels_(1 << 24);
+
+    namespace
+    {
+        // 每个条带读取的原图像素数，使原图条带、调色结果和缩放结果能同时留在 L2 缓存中
+        const size_t TILE_PIXELS = 1 << 16;
+
+        // 单个对齐单元（含重叠行）允许的最大像素数，超过后分块已无法利用缓存
+        const size_t MAX_UNIT_PIXELS = 1 << 20;
+    }
+
+    bool TiledExecutor::canTile(const cv::Mat &image, const ColorPipeline &pipeline,
+                                int new_width, int new_height, const std::string &method)
+    {
+        if (image.empty() || new_width <= 0 || new_height <= 0)
+        {
+            return false;
+        }
+
+        if (image.total() < min_tiled_pixels_ || pipeline.empty() || !pipeline.isPointwise())
+        {
+            return false;
+        }
+
+        // 分块路径只处理 8 位单通道/BGR/BGRA 图像
+        if (image.depth() != CV_8U || image.channels() == 2 || image.channels() > 4 ||
+            pipeline.outputChannels(image.channels()) < 0)
+        {
+            return false;
+        }
+
+        // 原图每 unit_rows 行恰好对应输出的整数行，按这样的单元切分条带，各条带的插值坐标与整图直接缩放时一致
+        int units = std::gcd(image.rows, new_height);
+        int unit_rows = image.rows / units;
+        if (units < 2)
+        {
+            return false;
+        }
+
+        // 内置重采样器在图像边缘折叠权重，按条带执行与整图结果不一致
+        int interpolation = ImageScaling::interpolationFor(image.size(), new_width, new_height, method);
+        if (interpolation < 0)
+        {
+            return false;
+        }
+
+        // 区域插值缩小 4 倍以上时 ImageScaling 先建立 2 倍方框金字塔，结果与直接缩放不同，交给整图路径处理
+        if (interpolation == cv::INTER_AREA && Resampler::buildsPyramid(image.size(), cv::Size(new_width, new_height)))
+        {
+            return false;
+        }
+
+        int margin_units = (interpolationMargin(interpolation) + unit_rows - 1) / unit_rows;
+        size_t unit_pixels = static_cast<size_t>(unit_rows) * (1 + 2 * margin_units) * image.cols;
+        return unit_pixels <= MAX_UNIT_PIXELS;
+    }
+
+    bool TiledExecutor::run(const cv::Mat &image, cv::Mat &dst, const ColorPipeline &pipeline,
+                            int new_width, int new_height, const std::string &method)
+    {
+        if (!canTile(image, pipeline, new_width, new_height, method))
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Processing chain cannot be executed in tiles");
+            return false;
+        }
+
+        int interpolation = ImageScaling::interpolationFor(image.size(), new_width, new_height, method);
+        int units = std::gcd(image.rows, new_height);
+        int unit_rows = image.rows / units;
+        int unit_out_rows = new_height / units;
+        int margin_units = (interpolationMargin(interpolation) + unit_rows - 1) / unit_rows;
+        int units_per_tile = std::max<int>(1, static_cast<int>(TILE_PIXELS / (static_cast<size_t>(unit_rows) * image.cols)));
+
+        dst.create(new_height, new_width, CV_8UC(pipeline.outputChannels(image.channels())));
+
+        // 每个条带：取出带重叠行的原图窗口，调色后按原比例缩放，只保留非重叠部分写入结果
+        Parallel::forEachRowBand(units, unit_rows * image.cols, [&](const cv::Range &band)
+                                 {
+            cv::Mat colored;
+            cv::Mat scaled;
+            for (int unit = band.start; unit < band.end; unit += units_per_tile)
+            {
+                int unit_end = std::min(band.end, unit + units_per_tile);
+                int window_start = std::max(0, unit - margin_units);
+                int window_end = std::min(units, unit_end + margin_units);
+
+                cv::Mat window = image.rowRange(window_start * unit_rows, window_end * unit_rows);
+                pipeline.applyRegion(window, colored);
+                cv::resize(colored, scaled, cv::Size(new_width, (window_end - window_start) * unit_out_rows),
+                           0, 0, interpolation);
+
+                cv::Mat dst_rows = dst.rowRange(unit * unit_out_rows, unit_end * unit_out_rows);
+                scaled.rowRange((unit - window_start) * unit_out_rows, (unit_end - window_start) * unit_out_rows)
+                    .copyTo(dst_rows);
+            } });
+
+        Logger::log(LogLevel::IP_LOGLV_INFO,
+                    "Tiled execution: " + std::to_string(pipeline.size()) + " color layers and scaling to " +
+                        std::to_string(new_width) + "x" + std::to_string(new_height) + " in " +
+                        std::to_string((units + units_per_tile - 1) / units_per_tile) + " tiles");
+        return true;
+    }
+
+    void TiledExecutor::setMinTiledPixels(size_t pixels)
+    {
+        min_tiled_pixels_ = pixels;
+    }
+
+    size_t TiledExecutor::minTiledPixels()
+    {
+        return min_tiled_pixels_;
+    }
+
+    // 辅助函数：插值在每侧需要额外读取的原图行数（多留一行以吸收坐标计算的舍入）
+    int TiledExecutor::interpolationMargin(int interpolation)
+    {
+        switch (interpolation)
+        {
+        case cv::INTER_NEAREST:
+        case cv::INTER_LINEAR:
+        case cv::INTER_AREA:
+            return 2;
+        case cv::INTER_CUBIC:
+            return 3;
+        case cv::INTER_LANCZOS4:
+            return 5;
+        default:
+            return 5;
+        }
+    }
+
+} // namespace image_processor
@@ -5,7 +5,9 @@
 #include "color_processing.hpp"
 #include "image_scaling.hpp"
 #include "web_server.hpp"
+#include "parallel.hpp"
 #include <iostream>
+#include <cstdlib>
 #include <opencv2/core.hpp>
 
 using namespace image_processor;
@@ -212,6 +214,13 @@ int main()
         //     std::cout << "Failed to convert image to grayscale." << std::endl;
         // }
 
+        // 可通过环境变量 IMAGE_PROCESSOR_THREADS 配置图像处理的工作线程数
+        const char *threads_env = std::getenv("IMAGE_PROCESSOR_THREADS");
+        if (threads_env != nullptr)
+        {
+            Parallel::setThreadCount(std::atoi(threads_env));
+        }
+
         // 询问用户是否启动Web服务器
         std::cout << "\nDo you want to start the web server? (y/n): ";
         std::string start_server;
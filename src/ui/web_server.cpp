@@ -2,6 +2,11 @@
 #include "image_io.hpp"
 #include "image_scaling.hpp"
 #include "color_processing.hpp"
+#include "color_pipeline.hpp"
+#include "convolution.hpp"
+#include "tiled_executor.hpp"
+#include "pipeline_planner.hpp"
+#include "image_statistics.hpp"
 #include "compression.hpp"
 #include "logger.hpp"
 #include <opencv2/opencv.hpp>
@@ -13,6 +18,8 @@
 #include <crow/multipart.h>
 #include <string>
 #include <string_view>
+#include <algorithm>
+#include <cstring>
 
 bool ends_with(const std::string &str, const std::string &suffix)
 {
@@ -25,6 +32,83 @@ bool ends_with(const std::string &str, const std::string &suffix)
     return res;
 }
 
+// 根据文件头判断图像是否带有 Alpha 通道（PNG、WebP、TIFF），只有这些图像才需要按 IMREAD_UNCHANGED 解码
+// PNG：IHDR 的颜色类型为灰度+Alpha 或 RGBA，或者 IDAT 之前有 tRNS 透明色块；
+// WebP：扩展格式 VP8X 的 Alpha 标志，或无损格式 VP8L 头中的 alpha_is_used 位；TIFF：第一个 IFD 中有 ExtraSamples 标签
+bool has_alpha_channel(const std::vector<uchar> &data)
+{
+    auto starts_with = [&data](size_t offset, const char *magic, size_t length)
+    {
+        return data.size() >= offset + length && std::memcmp(data.data() + offset, magic, length) == 0;
+    };
+    auto read = [&data](size_t offset, size_t length, bool big_endian)
+    {
+        uint32_t value = 0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            uint32_t byte = data[offset + (big_endian ? i : length - 1 - i)];
+            value = (value << 8) | byte;
+        }
+        return value;
+    };
+
+    if (starts_with(0, "\x89PNG\r\n\x1a\n", 8))
+    {
+        if (data.size() < 26 || (data[25] != 4 && data[25] != 6))
+        {
+            // 没有 Alpha 的颜色类型，检查 IDAT 之前是否有 tRNS 块
+            for (size_t offset = 8; offset + 8 <= data.size();)
+            {
+                uint32_t length = read(offset, 4, true);
+                if (starts_with(offset + 4, "tRNS", 4))
+                {
+                    return true;
+                }
+                if (starts_with(offset + 4, "IDAT", 4) || length > data.size())
+                {
+                    return false;
+                }
+                offset += static_cast<size_t>(length) + 12;
+            }
+            return false;
+        }
+        return true;
+    }
+
+    if (starts_with(0, "RIFF", 4) && starts_with(8, "WEBP", 4))
+    {
+        if (starts_with(12, "VP8X", 4))
+        {
+            return data.size() > 20 && (data[20] & 0x10) != 0;
+        }
+        if (starts_with(12, "VP8L", 4))
+        {
+            return data.size() >= 25 && data[20] == 0x2f && (read(21, 4, false) & (1u << 28)) != 0;
+        }
+        return false;
+    }
+
+    bool little_endian = starts_with(0, "II*\0", 4);
+    if (little_endian || starts_with(0, "MM\0*", 4))
+    {
+        bool big_endian = !little_endian;
+        size_t ifd = data.size() >= 8 ? read(4, 4, big_endian) : 0;
+        if (ifd == 0 || ifd + 2 > data.size())
+        {
+            return false;
+        }
+        uint32_t entries = read(ifd, 2, big_endian);
+        for (uint32_t i = 0; i < entries && ifd + 2 + (i + 1) * 12 <= data.size(); ++i)
+        {
+            if (read(ifd + 2 + i * 12, 2, big_endian) == 338)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 namespace image_processor
 {
     const std::string PROJECT_DIR = "../../";
@@ -113,6 +197,9 @@ namespace image_processor
         CROW_ROUTE(app_, "/api/download").methods("GET"_method)([this](const crow::request &req)
                                                                 { return handleDownload(req); });
 
+        CROW_ROUTE(app_, "/api/stats").methods("POST"_method)([this](const crow::request &req)
+                                                              { return handleStats(req); });
+
         // 静态资源路由 - 带MIME类型支持
         CROW_ROUTE(app_, "/<string>/<string>")
         ([](std::string dir, std::string filename)
@@ -181,7 +268,7 @@ namespace image_processor
     }
 
     // 处理颜色操作的辅助方法
-    void WebServer::processColorOperations(const crow::json::rvalue &params_json, cv::Mat &processed_image)
+    void WebServer::processColorOperations(const crow::json::rvalue &params_json, cv::Mat &image, cv::Mat &buffer)
     {
         Logger::log(LogLevel::IP_LOGLV_INFO, "Server processing color operations request.");
         // 检查是否有colorOps参数
@@ -191,77 +278,136 @@ namespace image_processor
             return;
         }
 
+        // 先把所有颜色图层编译为流水线，再一次遍历完成处理
+        ColorPipeline pipeline;
+        buildColorPipeline(params_json, pipeline);
+
+        if (pipeline.empty())
+        {
+            return;
+        }
+
+        // 结果写入另一块缓冲区后交换，失败时置空图像由调用方报告
+        if (pipeline.apply(image, buffer))
+        {
+            cv::swap(image, buffer);
+        }
+        else
+        {
+            image.release();
+        }
+    }
+
+    // 将colorOps中的所有颜色图层加入流水线
+    void WebServer::buildColorPipeline(const crow::json::rvalue &params_json, ColorPipeline &pipeline)
+    {
+        // linearLight 为 true 时各图层在线性光下执行
+        if (params_json.has("linearLight") && params_json["linearLight"].t() == crow::json::type::True)
+        {
+            pipeline.setLinearLight(true);
+            Logger::log(LogLevel::IP_LOGLV_INFO, "Color layers will be applied in linear light");
+        }
+
         // 检查colorOps是否为数组
         if (params_json["colorOps"].t() != crow::json::type::List)
         {
             // 处理单个对象情况
-            const auto &colorOp = params_json["colorOps"];
-
-            // 检查是否有type参数
-            if (colorOp.has("type"))
+            addColorOperation(params_json["colorOps"], pipeline);
+        }
+        else
+        {
+            // 遍历所有颜色图层，从上到下处理
+            for (const auto &colorOp : params_json["colorOps"])
             {
-                std::string operation = colorOp["type"].s();
-
-                if (operation == "grayscale")
-                {
-                    processGrayscaleOperation(colorOp, processed_image);
-                }
-                else if (operation == "brightness")
-                {
-                    processBrightnessOperation(colorOp, processed_image);
-                }
-                else if (operation == "contrast")
-                {
-                    processContrastOperation(colorOp, processed_image);
-                }
-                else if (operation == "saturation")
-                {
-                    processSaturationOperation(colorOp, processed_image);
-                }
-                else if (operation == "invert")
-                {
-                    processInvertOperation(colorOp, processed_image);
-                }
+                addColorOperation(colorOp, pipeline);
             }
-            return;
         }
+    }
 
-        // 遍历所有颜色图层，从上到下处理
-        for (const auto &colorOp : params_json["colorOps"])
+    // 根据图层类型将颜色操作加入流水线
+    void WebServer::addColorOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline)
+    {
+        // 检查是否有type参数
+        if (!colorOp.has("type"))
         {
-            // 检查是否有type参数
-            if (!colorOp.has("type"))
-            {
-                continue;
-            }
+            return;
+        }
 
-            std::string operation = colorOp["type"].s();
+        std::string operation = colorOp["type"].s();
 
-            if (operation == "grayscale")
-            {
-                processGrayscaleOperation(colorOp, processed_image);
-            }
-            else if (operation == "brightness")
-            {
-                processBrightnessOperation(colorOp, processed_image);
-            }
-            else if (operation == "contrast")
-            {
-                processContrastOperation(colorOp, processed_image);
-            }
-            else if (operation == "saturation")
-            {
-                processSaturationOperation(colorOp, processed_image);
-            }
-            else if (operation == "invert")
-            {
-                processInvertOperation(colorOp, processed_image);
-            }
+        if (operation == "grayscale")
+        {
+            processGrayscaleOperation(colorOp, pipeline);
+        }
+        else if (operation == "brightness")
+        {
+            processBrightnessOperation(colorOp, pipeline);
+        }
+        else if (operation == "contrast")
+        {
+            processContrastOperation(colorOp, pipeline);
+        }
+        else if (operation == "saturation")
+        {
+            processSaturationOperation(colorOp, pipeline);
+        }
+        else if (operation == "invert")
+        {
+            processInvertOperation(colorOp, pipeline);
+        }
+        else if (operation == "equalize")
+        {
+            processEqualizeOperation(colorOp, pipeline);
+        }
+        else if (operation == "lut3d")
+        {
+            processLut3DOperation(colorOp, pipeline);
+        }
+        else if (operation == "autolevels")
+        {
+            processAutoLevelsOperation(colorOp, pipeline);
+        }
+        else if (operation == "autowb")
+        {
+            processAutoWhiteBalanceOperation(colorOp, pipeline);
+        }
+        else if (operation == "blur")
+        {
+            processBlurOperation(colorOp, pipeline);
+        }
+        else if (operation == "gaussian")
+        {
+            processGaussianBlurOperation(colorOp, pipeline);
+        }
+        else if (operation == "unsharp")
+        {
+            processUnsharpMaskOperation(colorOp, pipeline);
+        }
+        else if (operation == "sharpen")
+        {
+            processSharpenOperation(colorOp, pipeline);
+        }
+        else if (operation == "guided")
+        {
+            processGuidedFilterOperation(colorOp, pipeline);
+        }
+        else if (operation == "dilate" || operation == "erode" || operation == "open" || operation == "close" ||
+                 operation == "median")
+        {
+            processRankFilterOperation(operation, colorOp, pipeline);
+        }
+        else if (operation == "convolve")
+        {
+            processConvolutionOperation(colorOp, pipeline);
+        }
+        else if (operation == "binarize")
+        {
+            processBinarizeOperation(colorOp, pipeline);
         }
     }
 
     // 处理灰度转换操作
-    void WebServer::processGrayscaleOperation(const crow::json::rvalue &colorOp, cv::Mat &processed_image)
+    void WebServer::processGrayscaleOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline)
     {
         // 检查是否有自定义灰度参数
         if (colorOp.has("params") && colorOp["params"].has("type"))
@@ -273,57 +419,315 @@ namespace image_processor
                 double r = colorOp["params"]["r"].d();
                 double g = colorOp["params"]["g"].d();
                 double b = colorOp["params"]["b"].d();
-                processed_image = ColorProcessing::convertToGrayscale(processed_image, r, g, b);
+                pipeline.addGrayscale(r, g, b);
             }
             else
             {
-                processed_image = ColorProcessing::convertToGrayscale(processed_image);
+                pipeline.addGrayscale();
             }
         }
         else
         {
-            processed_image = ColorProcessing::convertToGrayscale(processed_image);
+            pipeline.addGrayscale();
         }
     }
 
     // 处理亮度调整操作
-    void WebServer::processBrightnessOperation(const crow::json::rvalue &colorOp, cv::Mat &processed_image)
+    void WebServer::processBrightnessOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline)
     {
         if (colorOp.has("params") && colorOp["params"].has("value"))
         {
             int brightness = colorOp["params"]["value"].i();
-            processed_image = ColorProcessing::adjustBrightness(processed_image, brightness);
+            pipeline.addBrightness(brightness);
         }
     }
 
     // 处理对比度调整操作
-    void WebServer::processContrastOperation(const crow::json::rvalue &colorOp, cv::Mat &processed_image)
+    void WebServer::processContrastOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline)
     {
         if (colorOp.has("params") && colorOp["params"].has("value"))
         {
             int contrast = colorOp["params"]["value"].i();
-            processed_image = ColorProcessing::adjustContrast(processed_image, contrast);
+            pipeline.addContrast(contrast);
         }
     }
 
     // 处理饱和度调整操作
-    void WebServer::processSaturationOperation(const crow::json::rvalue &colorOp, cv::Mat &processed_image)
+    void WebServer::processSaturationOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline)
     {
         if (colorOp.has("params") && colorOp["params"].has("value"))
         {
             int saturation = colorOp["params"]["value"].i();
-            processed_image = ColorProcessing::adjustSaturation(processed_image, saturation);
+
+            // mode 为 "hsv" 时使用旧版 HSV 算法，保证与旧版本输出逐位一致
+            SaturationMode mode = SaturationMode::LUMA;
+            if (colorOp["params"].has("mode") && colorOp["params"]["mode"].s() == "hsv")
+            {
+                mode = SaturationMode::HSV;
+            }
+            pipeline.addSaturation(saturation, mode);
         }
     }
 
     // 处理反色操作
-    void WebServer::processInvertOperation(const crow::json::rvalue &colorOp, cv::Mat &processed_image)
+    void WebServer::processInvertOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline)
+    {
+        pipeline.addInvert();
+    }
+
+    // 处理直方图均衡化操作
+    void WebServer::processEqualizeOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline)
+    {
+        // mode 为 "adaptive" 时使用分块自适应均衡化，可选 clipLimit 和 tiles 参数（tiles 限制在 1 到 MAX_TILE_GRID 之间）
+        if (colorOp.has("params") && colorOp["params"].has("mode") && colorOp["params"]["mode"].s() == "adaptive")
+        {
+            double clip_limit = colorOp["params"].has("clipLimit") ? colorOp["params"]["clipLimit"].d() : 2.0;
+            int64_t tiles = colorOp["params"].has("tiles") ? colorOp["params"]["tiles"].i() : 8;
+            int tile_grid = static_cast<int>(std::min<int64_t>(std::max<int64_t>(tiles, 1), ColorProcessing::MAX_TILE_GRID));
+            pipeline.addEqualize(EqualizeMode::ADAPTIVE, clip_limit, tile_grid);
+        }
+        else
+        {
+            pipeline.addEqualize(EqualizeMode::GLOBAL);
+        }
+    }
+
+    // 处理三维查找表调色操作
+    void WebServer::processLut3DOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline)
+    {
+        // params.cube 为 .cube 文件的文本内容；相同内容的查找表只解析一次
+        if (!colorOp.has("params") || !colorOp["params"].has("cube"))
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "3D LUT layer has no cube data, layer skipped");
+            return;
+        }
+
+        std::shared_ptr<const ColorLut3D> lut = ColorLut3D::fromCube(colorOp["params"]["cube"].s());
+        if (!lut)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Invalid 3D LUT data, layer skipped");
+            return;
+        }
+        pipeline.addLut3D(lut);
+    }
+
+    // 处理自动色阶操作
+    void WebServer::processAutoLevelsOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline)
+    {
+        // clip 为两端各裁剪的百分比；sampleStep 为统计时的抽样间隔，0 表示按图像尺寸自动选择
+        double clip_percent = 0.5;
+        int sample_step = 1;
+        if (colorOp.has("params"))
+        {
+            if (colorOp["params"].has("clip"))
+            {
+                clip_percent = colorOp["params"]["clip"].d();
+            }
+            if (colorOp["params"].has("sampleStep"))
+            {
+                sample_step = static_cast<int>(colorOp["params"]["sampleStep"].i());
+            }
+        }
+        pipeline.addAutoLevels(clip_percent, sample_step);
+    }
+
+    // 处理自动白平衡操作
+    void WebServer::processAutoWhiteBalanceOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline)
+    {
+        int sample_step = 1;
+        if (colorOp.has("params") && colorOp["params"].has("sampleStep"))
+        {
+            sample_step = static_cast<int>(colorOp["params"]["sampleStep"].i());
+        }
+        pipeline.addAutoWhiteBalance(sample_step);
+    }
+
+    // 处理方框模糊操作
+    void WebServer::processBlurOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline)
+    {
+        if (colorOp.has("params") && colorOp["params"].has("radius"))
+        {
+            pipeline.addBlur(static_cast<int>(colorOp["params"]["radius"].i()));
+        }
+    }
+
+    // 处理高斯模糊操作
+    void WebServer::processGaussianBlurOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline)
+    {
+        if (colorOp.has("params") && colorOp["params"].has("sigma"))
+        {
+            pipeline.addGaussianBlur(colorOp["params"]["sigma"].d());
+        }
+    }
+
+    // 处理 USM 锐化操作
+    void WebServer::processUnsharpMaskOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline)
+    {
+        // radius 为高斯模糊的 sigma，amount 为锐化强度，可选 threshold（8 位色阶）
+        if (colorOp.has("params") && colorOp["params"].has("radius") && colorOp["params"].has("amount"))
+        {
+            double threshold = colorOp["params"].has("threshold") ? colorOp["params"]["threshold"].d() : 0.0;
+            pipeline.addUnsharpMask(colorOp["params"]["radius"].d(), colorOp["params"]["amount"].d(), threshold);
+        }
+    }
+
+    // 处理锐化操作
+    void WebServer::processSharpenOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline)
+    {
+        if (colorOp.has("params") && colorOp["params"].has("amount"))
+        {
+            pipeline.addSharpen(colorOp["params"]["amount"].d());
+        }
+    }
+
+    // 处理导向滤波（保边平滑）操作
+    void WebServer::processGuidedFilterOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline)
+    {
+        // eps 以满量程为 1 计，默认 0.01（约相当于 25 个 8 位色阶的标准差）
+        if (colorOp.has("params") && colorOp["params"].has("radius"))
+        {
+            double eps = colorOp["params"].has("eps") ? colorOp["params"]["eps"].d() : 0.01;
+            pipeline.addGuidedFilter(static_cast<int>(colorOp["params"]["radius"].i()), eps);
+        }
+    }
+
+    // 处理形态学（膨胀/腐蚀/开/闭运算）和中值滤波操作，参数都只有窗口半径
+    void WebServer::processRankFilterOperation(const std::string &operation, const crow::json::rvalue &colorOp, ColorPipeline &pipeline)
+    {
+        if (!colorOp.has("params") || !colorOp["params"].has("radius"))
+        {
+            return;
+        }
+
+        int radius = static_cast<int>(colorOp["params"]["radius"].i());
+        if (operation == "dilate")
+        {
+            pipeline.addDilate(radius);
+        }
+        else if (operation == "erode")
+        {
+            pipeline.addErode(radius);
+        }
+        else if (operation == "open")
+        {
+            pipeline.addOpen(radius);
+        }
+        else if (operation == "close")
+        {
+            pipeline.addClose(radius);
+        }
+        else
+        {
+            pipeline.addMedian(radius);
+        }
+    }
+
+    // 处理自定义卷积操作
+    void WebServer::processConvolutionOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline)
     {
-        processed_image = ColorProcessing::invertColors(processed_image);
+        // kernel 为按行排列的二维数组，各行长度必须相同；normalize 为 true 时按元素和归一化；
+        // method 可选 "auto"（默认）、"direct"、"separable" 或 "fft"
+        if (!colorOp.has("params") || !colorOp["params"].has("kernel") ||
+            colorOp["params"]["kernel"].t() != crow::json::type::List)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Convolution layer requires a kernel array");
+            return;
+        }
+
+        std::vector<std::vector<double>> rows;
+        for (const auto &row : colorOp["params"]["kernel"])
+        {
+            if (row.t() != crow::json::type::List || (!rows.empty() && row.size() != rows[0].size()))
+            {
+                Logger::log(LogLevel::IP_LOGLV_ERROR, "Convolution kernel rows must be arrays of the same length");
+                return;
+            }
+            rows.emplace_back();
+            for (const auto &value : row)
+            {
+                rows.back().push_back(value.d());
+            }
+        }
+
+        int kernel_rows = static_cast<int>(rows.size());
+        int kernel_cols = rows.empty() ? 0 : static_cast<int>(rows[0].size());
+        if (kernel_rows == 0 || kernel_cols == 0 || kernel_rows > Convolution::MAX_KERNEL_SIZE ||
+            kernel_cols > Convolution::MAX_KERNEL_SIZE)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Invalid convolution kernel size");
+            return;
+        }
+
+        cv::Mat kernel(kernel_rows, kernel_cols, CV_64F);
+        for (int i = 0; i < kernel_rows; ++i)
+        {
+            std::copy(rows[i].begin(), rows[i].end(), kernel.ptr<double>(i));
+        }
+
+        if (colorOp["params"].has("normalize") && colorOp["params"]["normalize"].t() == crow::json::type::True)
+        {
+            double sum = cv::sum(kernel)[0];
+            if (sum != 0.0)
+            {
+                kernel /= sum;
+            }
+        }
+
+        ConvolutionMethod method = ConvolutionMethod::AUTO;
+        if (colorOp["params"].has("method"))
+        {
+            std::string name = colorOp["params"]["method"].s();
+            if (name == "direct")
+            {
+                method = ConvolutionMethod::DIRECT;
+            }
+            else if (name == "separable")
+            {
+                method = ConvolutionMethod::SEPARABLE;
+            }
+            else if (name == "fft")
+            {
+                method = ConvolutionMethod::FFT;
+            }
+        }
+        pipeline.addConvolution(kernel, method);
+    }
+
+    // 处理二值化操作
+    void WebServer::processBinarizeOperation(const crow::json::rvalue &colorOp, ColorPipeline &pipeline)
+    {
+        // mode 为 "fixed"（默认，使用 threshold）、"otsu" 或 "adaptive"（使用 radius 和 offset）；
+        // invert 为 true 时暗像素输出为 255
+        BinarizeMode mode = BinarizeMode::FIXED;
+        double threshold = 128.0;
+        int radius = 15;
+        double offset = 10.0;
+        bool invert = false;
+        if (colorOp.has("params"))
+        {
+            const crow::json::rvalue &params = colorOp["params"];
+            if (params.has("mode"))
+            {
+                std::string name = params["mode"].s();
+                if (name == "otsu")
+                {
+                    mode = BinarizeMode::OTSU;
+                }
+                else if (name == "adaptive")
+                {
+                    mode = BinarizeMode::ADAPTIVE;
+                }
+            }
+            threshold = params.has("threshold") ? params["threshold"].d() : threshold;
+            radius = params.has("radius") ? static_cast<int>(params["radius"].i()) : radius;
+            offset = params.has("offset") ? params["offset"].d() : offset;
+            invert = params.has("invert") && params["invert"].t() == crow::json::type::True;
+        }
+        pipeline.addBinarize(mode, threshold, radius, offset, invert);
     }
 
     // 处理缩放操作的辅助方法
-    void WebServer::processScaleOperations(const crow::json::rvalue &params_json, cv::Mat &processed_image)
+    void WebServer::processScaleOperations(const crow::json::rvalue &params_json, cv::Mat &image, cv::Mat &buffer)
     {
         if (!params_json.has("scaleOp"))
         {
@@ -343,17 +747,117 @@ namespace image_processor
         if (scale_type == "factor" && scaleOp.has("factor"))
         {
             double factor = scaleOp["factor"].d();
-            processed_image = ImageScaling::scaleImageByFactor(processed_image, factor);
+            ImageScaling::scaleImageByFactor(image, buffer, factor);
+            cv::swap(image, buffer);
         }
         else if (scale_type == "dimensions" && scaleOp.has("width") && scaleOp.has("height"))
         {
             int width = scaleOp["width"].i();
             int height = scaleOp["height"].i();
             std::string method = params_json.has("method") ? params_json["method"].s() : std::string("default");
-            processed_image = ImageScaling::scaleImage(processed_image, width, height, method);
+            ImageScaling::scaleImage(image, buffer, width, height, method);
+            cv::swap(image, buffer);
         }
     }
 
+    // 解析缩放操作的目标尺寸和插值方法（与 processScaleOperations 的规则一致）
+    bool WebServer::resolveScaleSize(const crow::json::rvalue &params_json, const cv::Size &image_size,
+                                     int &width, int &height, std::string &method)
+    {
+        const crow::json::rvalue &scaleOp = params_json["scaleOp"];
+        if (!scaleOp.has("type"))
+        {
+            return false;
+        }
+
+        std::string scale_type = scaleOp["type"].s();
+        if (scale_type == "factor" && scaleOp.has("factor"))
+        {
+            double factor = scaleOp["factor"].d();
+            width = static_cast<int>(image_size.width * factor);
+            height = static_cast<int>(image_size.height * factor);
+            method = "default";
+            return factor > 0.0;
+        }
+        if (scale_type == "dimensions" && scaleOp.has("width") && scaleOp.has("height"))
+        {
+            width = scaleOp["width"].i();
+            height = scaleOp["height"].i();
+            method = params_json.has("method") ? params_json["method"].s() : std::string("default");
+            return true;
+        }
+        return false;
+    }
+
+    // 大图同时有颜色和缩放操作时分块执行整条处理链，返回 false 表示需要逐步处理
+    bool WebServer::processTiledOperations(const crow::json::rvalue &params_json, cv::Mat &image, cv::Mat &buffer)
+    {
+        int width = 0;
+        int height = 0;
+        std::string method;
+        if (!resolveScaleSize(params_json, image.size(), width, height, method))
+        {
+            return false;
+        }
+
+        ColorPipeline pipeline;
+        buildColorPipeline(params_json, pipeline);
+        if (!TiledExecutor::canTile(image, pipeline, width, height, method))
+        {
+            return false;
+        }
+
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Processing color and scale operations in tiles");
+        if (TiledExecutor::run(image, buffer, pipeline, width, height, method))
+        {
+            cv::swap(image, buffer);
+        }
+        else
+        {
+            image.release();
+        }
+        return true;
+    }
+
+    // 缩小图像时由规划器决定能否先缩放再执行末尾的逐像素颜色图层，返回 false 表示保持原顺序
+    bool WebServer::processPlannedOperations(const crow::json::rvalue &params_json, cv::Mat &image, cv::Mat &buffer)
+    {
+        int width = 0;
+        int height = 0;
+        std::string method;
+        if (!resolveScaleSize(params_json, image.size(), width, height, method))
+        {
+            return false;
+        }
+
+        // reorderTolerance 为允许的平均误差（8 位色阶），0 表示不调整顺序
+        double tolerance = PipelinePlanner::tolerance();
+        if (params_json.has("reorderTolerance") && params_json["reorderTolerance"].t() == crow::json::type::Number)
+        {
+            tolerance = params_json["reorderTolerance"].d();
+        }
+
+        ColorPipeline pipeline;
+        buildColorPipeline(params_json, pipeline);
+        size_t split = PipelinePlanner::scaleSplit(image, pipeline, width, height, method, tolerance);
+        if (split >= pipeline.size())
+        {
+            return false;
+        }
+
+        Logger::log(LogLevel::IP_LOGLV_INFO, "Processing " + std::to_string(split) + " color layer(s), scaling, then " +
+                                                 std::to_string(pipeline.size() - split) + " color layer(s)");
+        if (PipelinePlanner::run(image, buffer, pipeline, split, width, height, method))
+        {
+            cv::swap(image, buffer);
+        }
+        else
+        {
+            image.release();
+        }
+        return true;
+    }
+
     crow::response WebServer::handleProcess(const crow::request &req)
     {
         try
@@ -367,49 +871,50 @@ namespace image_processor
                 return crow::response(400, generateResponse(false, "No image provided"));
             }
 
-            // 获取图像数据
-            auto &image_part = msg.part_map.find("image")->second;
-
-            // 将图像数据转换为cv::Mat
-            std::vector<uchar> image_data(image_part.body.begin(), image_part.body.end());
-            cv::Mat image = cv::imdecode(image_data, cv::IMREAD_COLOR);
+            // 获取参数并解码图像
+            crow::json::rvalue params_json;
+            bool has_params = false;
+            cv::Mat image = decodeRequest(msg, params_json, has_params);
 
             if (image.empty())
             {
                 return crow::response(400, generateResponse(false, "Invalid image data"));
             }
 
-            // 获取参数
-            cv::Mat processed_image = image.clone();
-            crow::json::rvalue params_json = crow::json::load("{}");
-            bool has_params = false;
+            // 解码后的图像与 buffer 交替作为各处理步骤的输入和输出，整个请求只占用两块图像内存
+            cv::Mat buffer;
 
-            // 检查是否有参数
-            if (msg.part_map.find("params") != msg.part_map.end())
+            // 先处理颜色操作（支持图层系统）
+            if (has_params)
             {
-                auto &params_part = msg.part_map.find("params")->second;
-                std::string params_str(params_part.body.begin(), params_part.body.end());
-
-                // 直接解析为rvalue类型
-                auto parsed_json = crow::json::load(params_str);
-                if (parsed_json.t() != crow::json::type::Null)
+                // 添加调试日志，输出params_json内容（3D LUT 等大段数据截断显示）
+                std::string params_text = (std::string)params_json;
+                if (params_text.size() > 2048)
                 {
-                    params_json = parsed_json;
-                    has_params = true;
+                    params_text = params_text.substr(0, 2048) + "... (" + std::to_string(params_text.size()) + " bytes)";
                 }
-            }
+                Logger::log(LogLevel::IP_LOGLV_INFO, "Received params: " + params_text);
 
-            // 先处理颜色操作（支持图层系统）
-            if (has_params)
-            {
-                // 添加调试日志，输出整个params_json内容
-                Logger::log(LogLevel::IP_LOGLV_INFO, "Received params: " + (std::string)params_json);
+                // 缩小图像时先尝试把缩放提前到末尾的逐像素颜色图层之前；
+                // 否则超大图像同时调色和缩放时，整条处理链在缓存大小的条带上一次完成
+                bool planned = params_json.has("colorOps") && params_json.has("scaleOp") &&
+                               processPlannedOperations(params_json, image, buffer);
+                bool tiled = planned || (params_json.has("colorOps") && params_json.has("scaleOp") &&
+                                         processTiledOperations(params_json, image, buffer));
 
                 // 检查是否有colorOps参数
-                if (params_json.has("colorOps"))
+                if (planned)
+                {
+                    Logger::log(LogLevel::IP_LOGLV_INFO, "Color and scale operations processed in planned order");
+                }
+                else if (tiled)
+                {
+                    Logger::log(LogLevel::IP_LOGLV_INFO, "Color and scale operations processed in tiles");
+                }
+                else if (params_json.has("colorOps"))
                 {
                     Logger::log(LogLevel::IP_LOGLV_INFO, "Processing color operations");
-                    processColorOperations(params_json, processed_image);
+                    processColorOperations(params_json, image, buffer);
                 }
                 else
                 {
@@ -417,24 +922,24 @@ namespace image_processor
                 }
 
                 // 后处理缩放操作
-                if (params_json.has("scaleOp"))
+                if (!tiled && params_json.has("scaleOp"))
                 {
                     Logger::log(LogLevel::IP_LOGLV_INFO, "Processing scale operations");
-                    processScaleOperations(params_json, processed_image);
+                    processScaleOperations(params_json, image, buffer);
                 }
-                else
+                else if (!tiled)
                 {
                     Logger::log(LogLevel::IP_LOGLV_INFO, "No scaleOp found in params");
                 }
             }
 
-            if (processed_image.empty())
+            if (image.empty())
             {
                 return crow::response(500, generateResponse(false, "Image processing failed"));
             }
 
             // 将处理后的图像转换为base64字符串
-            std::string result_data = imageToString(processed_image);
+            std::string result_data = imageToString(image);
 
             return crow::response(generateResponse(true, "Processing successful", result_data));
         }
@@ -445,6 +950,92 @@ namespace image_processor
         }
     }
 
+    crow::response WebServer::handleStats(const crow::request &req)
+    {
+        try
+        {
+            // 解析multipart/form-data，与 /api/process 使用相同的解码方式
+            crow::multipart::message msg(req);
+
+            if (msg.part_map.find("image") == msg.part_map.end())
+            {
+                return crow::response(400, generateResponse(false, "No image provided"));
+            }
+
+            crow::json::rvalue params_json;
+            bool has_params = false;
+            cv::Mat image = decodeRequest(msg, params_json, has_params);
+
+            if (image.empty())
+            {
+                return crow::response(400, generateResponse(false, "Invalid image data"));
+            }
+
+            // 可选的 percentiles 参数指定要计算的百分位（0-100）
+            ImageStats stats;
+            bool ok;
+            if (has_params && params_json.has("percentiles") && params_json["percentiles"].t() == crow::json::type::List)
+            {
+                std::vector<double> levels;
+                for (const auto &level : params_json["percentiles"])
+                {
+                    levels.push_back(level.d());
+                }
+                ok = ImageStatistics::compute(image, stats, levels);
+            }
+            else
+            {
+                ok = ImageStatistics::compute(image, stats);
+            }
+
+            if (!ok)
+            {
+                return crow::response(400, generateResponse(false, "Failed to compute image statistics"));
+            }
+
+            // 通道名称按 OpenCV 的通道顺序
+            static const char *const channel_names[][4] = {{"Gray"}, {}, {"B", "G", "R"}, {"B", "G", "R", "A"}};
+            const char *depth_name = stats.depth == CV_8U ? "8U" : (stats.depth == CV_16U ? "16U" : "32F");
+
+            crow::json::wvalue response;
+            response["success"] = true;
+            response["message"] = "Statistics computed";
+            response["data"]["width"] = stats.width;
+            response["data"]["height"] = stats.height;
+            response["data"]["depth"] = depth_name;
+            response["data"]["maxValue"] = stats.max_value;
+
+            std::vector<crow::json::wvalue> levels(stats.percentile_levels.begin(), stats.percentile_levels.end());
+            response["data"]["percentiles"] = std::move(levels);
+
+            std::vector<crow::json::wvalue> channels;
+            for (size_t c = 0; c < stats.channels.size(); ++c)
+            {
+                const ChannelStats &channel = stats.channels[c];
+                crow::json::wvalue entry;
+                entry["name"] = channel_names[stats.channels.size() - 1][c];
+                entry["mean"] = channel.mean;
+                entry["min"] = channel.min;
+                entry["max"] = channel.max;
+
+                std::vector<crow::json::wvalue> percentiles(channel.percentiles.begin(), channel.percentiles.end());
+                entry["percentiles"] = std::move(percentiles);
+
+                std::vector<crow::json::wvalue> histogram(channel.histogram.begin(), channel.histogram.end());
+                entry["histogram"] = std::move(histogram);
+                channels.push_back(std::move(entry));
+            }
+            response["data"]["channels"] = std::move(channels);
+
+            return crow::response(response);
+        }
+        catch (const std::exception &e)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Statistics failed: " + std::string(e.what()));
+            return crow::response(generateResponse(false, "Statistics failed: " + std::string(e.what())));
+        }
+    }
+
     crow::response WebServer::handleDownload(const crow::request &req)
     {
         try
@@ -483,11 +1074,133 @@ namespace image_processor
         return image;
     }
 
+    // 解析请求中的 params 部分，再按其中的精度参数解码 image 部分；解码失败返回空图像
+    cv::Mat WebServer::decodeRequest(const crow::multipart::message &msg, crow::json::rvalue &params_json, bool &has_params)
+    {
+        params_json = crow::json::load("{}");
+        has_params = false;
+
+        // 检查是否有参数
+        auto params_it = msg.part_map.find("params");
+        if (params_it != msg.part_map.end())
+        {
+            std::string params_str(params_it->second.body.begin(), params_it->second.body.end());
+
+            // 直接解析为rvalue类型
+            auto parsed_json = crow::json::load(params_str);
+            if (parsed_json.t() != crow::json::type::Null)
+            {
+                params_json = parsed_json;
+                has_params = true;
+            }
+        }
+
+        auto image_it = msg.part_map.find("image");
+        if (image_it == msg.part_map.end())
+        {
+            return cv::Mat();
+        }
+
+        // 将图像数据转换为cv::Mat（高精度模式保留原始位深，直到最终编码时才量化）
+        bool high_precision = has_params && params_json.has("precision") && params_json["precision"].s() == "high";
+        std::vector<uchar> image_data(image_it->second.body.begin(), image_it->second.body.end());
+        return decodeImage(image_data, high_precision);
+    }
+
+    cv::Mat WebServer::decodeImage(const std::vector<uchar> &data, bool high_precision)
+    {
+        // 只有确实带 Alpha 通道的图像按 IMREAD_UNCHANGED 解码；其余图像解码时会应用 EXIF 方向信息：
+        // 普通模式按原方式解码为 8 位 BGR，高精度模式保留原始位深和灰度/彩色
+        bool alpha = has_alpha_channel(data);
+        if (!alpha && !high_precision)
+        {
+            return cv::imdecode(data, cv::IMREAD_COLOR);
+        }
+
+        cv::Mat image = cv::imdecode(data, alpha ? cv::IMREAD_UNCHANGED : cv::IMREAD_ANYDEPTH | cv::IMREAD_ANYCOLOR);
+        if (image.empty())
+        {
+            return image;
+        }
+
+        // 带透明度的图像保持 BGRA，各图层只处理颜色通道；其余统一为灰度或 BGR 图像
+        if (image.channels() == 2)
+        {
+            // 灰度 + Alpha 展开为 BGRA
+            cv::Mat bgra(image.size(), CV_MAKETYPE(image.depth(), 4));
+            const int from_to[] = {0, 0, 0, 1, 0, 2, 1, 3};
+            cv::mixChannels(&image, 1, &bgra, 1, from_to, 4);
+            image = bgra;
+        }
+        if (image.channels() > 4)
+        {
+            Logger::log(LogLevel::IP_LOGLV_ERROR, "Unsupported channel count: " + std::to_string(image.channels()));
+            return cv::Mat();
+        }
+
+        if (!high_precision)
+        {
+            // 普通模式保持与 IMREAD_COLOR 相同的 8 位输出（16 位取高 8 位），只额外保留 Alpha 通道
+            if (image.depth() == CV_16U)
+            {
+                cv::Mat high_bytes(image.size(), CV_8UC(image.channels()));
+                size_t row_elements = static_cast<size_t>(image.cols) * image.channels();
+                for (int i = 0; i < image.rows; ++i)
+                {
+                    const ushort *src = image.ptr<ushort>(i);
+                    uchar *dst = high_bytes.ptr<uchar>(i);
+                    for (size_t e = 0; e < row_elements; ++e)
+                    {
+                        dst[e] = static_cast<uchar>(src[e] >> 8);
+                    }
+                }
+                image = high_bytes;
+            }
+            else if (image.depth() != CV_8U)
+            {
+                image.convertTo(image, CV_8U, image.depth() == CV_32F ? 255.0 : 1.0);
+            }
+            if (image.channels() == 1)
+            {
+                cv::cvtColor(image, image, cv::COLOR_GRAY2BGR);
+            }
+            if (image.channels() == 4)
+            {
+                Logger::log(LogLevel::IP_LOGLV_INFO, "Image has an alpha channel, transparency will be preserved");
+            }
+            return image;
+        }
+
+        // 8 位图像提升为 16 位，避免各图层之间按 8 位取整；16 位和浮点图像保持原样
+        if (image.depth() == CV_8U)
+        {
+            image.convertTo(image, CV_16U, 257.0);
+        }
+        else if (image.depth() != CV_16U && image.depth() != CV_32F)
+        {
+            image.convertTo(image, CV_32F);
+        }
+
+        Logger::log(LogLevel::IP_LOGLV_INFO, "High precision mode: working depth is " +
+                                                 std::string(image.depth() == CV_16U ? "16-bit" : "float") +
+                                                 (image.channels() == 4 ? " with alpha" : ""));
+        return image;
+    }
+
     std::string WebServer::imageToString(const cv::Mat &image)
     {
-        // 将图像编码为base64字符串
+        // 将图像编码为base64字符串（PNG 支持 8 位和 16 位，浮点图像在此量化为 16 位）
         std::vector<uchar> buffer;
-        cv::imencode(".png", image, buffer);
+        if (image.depth() == CV_32F || image.depth() == CV_64F)
+        {
+            cv::Mat quantized;
+            image.convertTo(quantized, CV_16U, 65535.0);
+            cv::imencode(".png", quantized, buffer);
+        }
+        else
+        {
+            cv::imencode(".png", image, buffer);
+        }
         std::string raw_data(buffer.begin(), buffer.end());
         // 使用Crow库的base64编码功能
         return crow::utility::base64encode(raw_data, raw_data.size());
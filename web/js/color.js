@@ -11,6 +11,11 @@
 // [≡ 亮度 [滑块(-100-100)] $滑块对应的数字(可双击手动填写)$  ×]
 // [≡ 对比度 [滑块(-100-100)] $滑块对应的数字(可双击手动填写)$  ×]
 // [≡ 饱和度 [滑块(-100-100)] $滑块对应的数字(可双击手动填写)$  ×]
+// [≡ 直方图均衡化 [全局/自适应(这是一个下拉选项卡)]  ×]
+// [≡ 3D LUT [选择 .cube 文件] $文件名$  ×]
+// [≡ 自动色阶  ×]
+// [≡ 自动白平衡  ×]
+// [≡ 方框模糊 半径:$可填写的数值$  ×]（高斯模糊、USM 锐化、锐化同理，每个参数一个输入框）
 
 import { els, colorLayers, dragSrcElement } from './state.js';
 
@@ -83,6 +88,44 @@ export function createColorLayer(operation) {
         case 'invert':
             // 反色没有参数
             break;
+        case 'equalize':
+            layer.params.mode = 'global';
+            break;
+        case 'lut3d':
+            // cube 为 .cube 文件的文本内容，随请求发送给后端
+            layer.params.cube = '';
+            layer.params.name = '';
+            break;
+        case 'autolevels':
+            // 两端各裁剪 0.5% 的像素；sampleStep 为 0 时后端按图像尺寸选择抽样间隔
+            layer.params.clip = 0.5;
+            layer.params.sampleStep = 0;
+            break;
+        case 'autowb':
+            layer.params.sampleStep = 0;
+            break;
+        case 'binarize':
+            // threshold 用于固定阈值，radius 和 offset 用于自适应阈值
+            layer.params.mode = 'otsu';
+            layer.params.threshold = 128;
+            layer.params.radius = 15;
+            layer.params.offset = 10;
+            layer.params.invert = false;
+            break;
+        case 'convolve':
+            // text 为卷积核文本（每行一行系数，以空格或逗号分隔），kernel 为解析后的二维数组
+            layer.params.text = '0 -1 0\n-1 5 -1\n0 -1 0';
+            layer.params.kernel = parseKernelText(layer.params.text);
+            layer.params.normalize = false;
+            break;
+        default:
+            // 数值参数图层使用各输入框的默认值
+            if (numberLayerFields[operation]) {
+                numberLayerFields[operation].fields.forEach(field => {
+                    layer.params[field.name] = field.value;
+                });
+            }
+            break;
     }
     
     return layer;
@@ -124,6 +167,29 @@ export function renderColorLayers() {
             case 'invert':
                 content.innerHTML = `<span class="layer-label">反色</span>`;
                 break;
+            case 'equalize':
+                content.innerHTML = createEqualizeLayerContent(layer);
+                break;
+            case 'lut3d':
+                content.innerHTML = createLut3DLayerContent(layer);
+                break;
+            case 'autolevels':
+                content.innerHTML = `<span class="layer-label">自动色阶</span>`;
+                break;
+            case 'autowb':
+                content.innerHTML = `<span class="layer-label">自动白平衡</span>`;
+                break;
+            case 'convolve':
+                content.innerHTML = createConvolveLayerContent(layer);
+                break;
+            case 'binarize':
+                content.innerHTML = createBinarizeLayerContent(layer);
+                break;
+            default:
+                if (numberLayerFields[layer.type]) {
+                    content.innerHTML = createNumberLayerContent(layer);
+                }
+                break;
         }
         
         layerElement.appendChild(content);
@@ -186,6 +252,105 @@ export function renderColorLayers() {
             }
         }
         
+        // 添加均衡化方式切换事件
+        if (layer.type === 'equalize') {
+            const modeSelect = layerElement.querySelector('.equalize-mode-select');
+            if (modeSelect) {
+                modeSelect.addEventListener('change', () => {
+                    updateLayerParam(layer.id, 'mode', modeSelect.value);
+                });
+            }
+        }
+        
+        // 添加数值参数输入事件
+        if (numberLayerFields[layer.type]) {
+            layerElement.querySelectorAll('.layer-param-input').forEach(input => {
+                input.addEventListener('change', () => {
+                    const value = parseFloat(input.value);
+                    if (!isNaN(value)) {
+                        updateLayerParam(layer.id, input.dataset.param, value);
+                    }
+                });
+            });
+        }
+        
+        // 添加 .cube 文件选择事件
+        if (layer.type === 'lut3d') {
+            const fileInput = layerElement.querySelector('.lut3d-file-input');
+            const fileName = layerElement.querySelector('.lut3d-file-name');
+            if (fileInput) {
+                fileInput.addEventListener('change', () => {
+                    const file = fileInput.files[0];
+                    if (!file) return;
+                    
+                    const reader = new FileReader();
+                    reader.onload = (e) => {
+                        updateLayerParam(layer.id, 'cube', e.target.result);
+                        updateLayerParam(layer.id, 'name', file.name);
+                        if (fileName) {
+                            fileName.textContent = file.name;
+                        }
+                    };
+                    reader.readAsText(file);
+                });
+            }
+        }
+        
+        // 添加二值化参数事件：只显示当前方式用到的参数
+        if (layer.type === 'binarize') {
+            const modeSelect = layerElement.querySelector('.binarize-mode-select');
+            const updateVisibility = () => {
+                layerElement.querySelectorAll('[data-binarize-mode]').forEach(item => {
+                    item.style.display = item.dataset.binarizeMode === modeSelect.value ? 'inline-block' : 'none';
+                });
+            };
+            if (modeSelect) {
+                updateVisibility();
+                modeSelect.addEventListener('change', () => {
+                    updateLayerParam(layer.id, 'mode', modeSelect.value);
+                    updateVisibility();
+                });
+            }
+            layerElement.querySelectorAll('.binarize-param-input').forEach(input => {
+                input.addEventListener('change', () => {
+                    const value = parseFloat(input.value);
+                    if (!isNaN(value)) {
+                        updateLayerParam(layer.id, input.dataset.param, value);
+                    }
+                });
+            });
+            const invertInput = layerElement.querySelector('.binarize-invert-input');
+            if (invertInput) {
+                invertInput.addEventListener('change', () => {
+                    updateLayerParam(layer.id, 'invert', invertInput.checked);
+                });
+            }
+        }
+        
+        // 添加卷积核编辑事件
+        if (layer.type === 'convolve') {
+            const kernelInput = layerElement.querySelector('.convolve-kernel-input');
+            const normalizeInput = layerElement.querySelector('.convolve-normalize-input');
+            if (kernelInput) {
+                kernelInput.addEventListener('change', () => {
+                    const kernel = parseKernelText(kernelInput.value);
+                    if (!kernel) {
+                        console.error(`id 为 ${layer.id} 的卷积核格式错误：各行系数个数必须相同`);
+                        kernelInput.classList.add('invalid');
+                        return;
+                    }
+                    kernelInput.classList.remove('invalid');
+                    updateLayerParam(layer.id, 'text', kernelInput.value);
+                    updateLayerParam(layer.id, 'kernel', kernel);
+                });
+            }
+            if (normalizeInput) {
+                normalizeInput.addEventListener('change', () => {
+                    updateLayerParam(layer.id, 'normalize', normalizeInput.checked);
+                });
+            }
+        }
+        
         // 添加灰度化类型切换事件
         if (layer.type === 'grayscale') {
             const typeSelect = layerElement.querySelector('.grayscale-type-select');
@@ -246,6 +411,150 @@ function createGrayscaleLayerContent(layer) {
     `;
 }
 
+// 创建直方图均衡化图层内容
+function createEqualizeLayerContent(layer) {
+    const isAdaptive = layer.params.mode === 'adaptive';
+    
+    return `
+        <span class="layer-label">直方图均衡化</span>
+        <select class="equalize-mode-select">
+            <option value="global" ${!isAdaptive ? 'selected' : ''}>全局</option>
+            <option value="adaptive" ${isAdaptive ? 'selected' : ''}>自适应</option>
+        </select>
+    `;
+}
+
+// 创建 3D LUT 图层内容
+function createLut3DLayerContent(layer) {
+    const name = layer.params.name || '未选择文件';
+    
+    return `
+        <span class="layer-label">3D LUT</span>
+        <label class="lut3d-file-button">
+            选择 .cube
+            <input type="file" class="lut3d-file-input" accept=".cube" hidden>
+        </label>
+        <span class="lut3d-file-name">${name}</span>
+    `;
+}
+
+// 创建二值化图层内容
+function createBinarizeLayerContent(layer) {
+    const mode = layer.params.mode;
+    const param = (name, text, min, max, step, binarizeMode) => `
+        <span class="grayscale-coefficient" data-binarize-mode="${binarizeMode}">
+            <label>${text}:</label>
+            <input type="number" class="binarize-param-input" data-param="${name}"
+                min="${min}" max="${max}" step="${step}" value="${layer.params[name]}">
+        </span>
+    `;
+    
+    return `
+        <span class="layer-label">二值化</span>
+        <select class="binarize-mode-select">
+            <option value="fixed" ${mode === 'fixed' ? 'selected' : ''}>固定阈值</option>
+            <option value="otsu" ${mode === 'otsu' ? 'selected' : ''}>大津法</option>
+            <option value="adaptive" ${mode === 'adaptive' ? 'selected' : ''}>自适应</option>
+        </select>
+        ${param('threshold', '阈值', 0, 255, 1, 'fixed')}
+        ${param('radius', '半径', 1, 1000, 1, 'adaptive')}
+        ${param('offset', '偏移', -255, 255, 1, 'adaptive')}
+        <label class="layer-checkbox">
+            <input type="checkbox" class="binarize-invert-input" ${layer.params.invert ? 'checked' : ''}>
+            反转
+        </label>
+    `;
+}
+
+// 解析卷积核文本：每行一行系数，以空格或逗号分隔；格式错误时返回 null
+function parseKernelText(text) {
+    const rows = text.trim().split(/\n+/).map(line =>
+        line.trim().split(/[\s,]+/).filter(item => item !== '').map(Number));
+    const cols = rows[0].length;
+    const valid = cols > 0 && rows.every(row => row.length === cols && row.every(Number.isFinite));
+    return valid ? rows : null;
+}
+
+// 创建自定义卷积图层内容
+function createConvolveLayerContent(layer) {
+    return `
+        <span class="layer-label">自定义卷积</span>
+        <textarea class="convolve-kernel-input" rows="3" spellcheck="false">${layer.params.text}</textarea>
+        <label class="layer-checkbox">
+            <input type="checkbox" class="convolve-normalize-input" ${layer.params.normalize ? 'checked' : ''}>
+            归一化
+        </label>
+    `;
+}
+
+// 数值参数图层：每个参数一个数字输入框，value 为默认值
+export const numberLayerFields = {
+    blur: {
+        label: '方框模糊',
+        fields: [{ name: 'radius', text: '半径', min: 1, max: 1000, step: 1, value: 5 }]
+    },
+    gaussian: {
+        label: '高斯模糊',
+        fields: [{ name: 'sigma', text: 'σ', min: 0.1, max: 500, step: 0.1, value: 5 }]
+    },
+    unsharp: {
+        label: 'USM 锐化',
+        fields: [
+            { name: 'radius', text: '半径', min: 0.1, max: 500, step: 0.1, value: 5 },
+            { name: 'amount', text: '数量', min: 0, max: 10, step: 0.1, value: 1 },
+            { name: 'threshold', text: '阈值', min: 0, max: 255, step: 1, value: 0 }
+        ]
+    },
+    sharpen: {
+        label: '锐化',
+        fields: [{ name: 'amount', text: '强度', min: 0, max: 10, step: 0.1, value: 1 }]
+    },
+    guided: {
+        label: '保边平滑',
+        fields: [
+            { name: 'radius', text: '半径', min: 1, max: 1000, step: 1, value: 8 },
+            { name: 'eps', text: 'ε', min: 0.0001, max: 1, step: 0.001, value: 0.01 }
+        ]
+    },
+    dilate: {
+        label: '膨胀',
+        fields: [{ name: 'radius', text: '半径', min: 1, max: 1000, step: 1, value: 1 }]
+    },
+    erode: {
+        label: '腐蚀',
+        fields: [{ name: 'radius', text: '半径', min: 1, max: 1000, step: 1, value: 1 }]
+    },
+    open: {
+        label: '开运算',
+        fields: [{ name: 'radius', text: '半径', min: 1, max: 1000, step: 1, value: 1 }]
+    },
+    close: {
+        label: '闭运算',
+        fields: [{ name: 'radius', text: '半径', min: 1, max: 1000, step: 1, value: 1 }]
+    },
+    median: {
+        label: '中值滤波',
+        fields: [{ name: 'radius', text: '半径', min: 1, max: 255, step: 1, value: 2 }]
+    }
+};
+
+// 创建数值参数图层内容
+function createNumberLayerContent(layer) {
+    const config = numberLayerFields[layer.type];
+    const inputs = config.fields.map(field => `
+        <span class="grayscale-coefficient">
+            <label>${field.text}:</label>
+            <input type="number" class="layer-param-input" data-param="${field.name}"
+                min="${field.min}" max="${field.max}" step="${field.step}" value="${layer.params[field.name]}">
+        </span>
+    `).join('');
+    
+    return `
+        <span class="layer-label">${config.label}</span>
+        ${inputs}
+    `;
+}
+
 // 创建带滑块的图层内容
 function createSliderLayerContent(layer) {
     const typeLabels = {
@@ -2,6 +2,7 @@
 // 图像处理功能
 
 import { els, currentFile, processedImageData, setProcessedImageData, colorLayers } from './state.js';
+import { numberLayerFields } from './color.js';
 
 export function initProcessEvents() {
     // 处理图像按钮事件
@@ -94,6 +95,16 @@ export function initProcessEvents() {
             console.log("未设置缩放选项");
         }
         
+        // 线性光模式：亮度、对比度、饱和度等图层在线性光下混合
+        if (document.getElementById('linearLight')?.checked) {
+            params.linearLight = true;
+        }
+        
+        // 高精度模式：后端保留 16 位/浮点精度处理并输出 16 位 PNG
+        if (document.getElementById('highPrecision')?.checked) {
+            params.precision = 'high';
+        }
+        
         // 添加调试日志，确认发送的参数
         console.log("发送到后端的完整参数:", params);
         console.log("JSON序列化后的参数:", JSON.stringify(params));
@@ -236,6 +247,41 @@ export function initProcessEvents() {
             // 反色操作不需要额外参数
             layer.params = {};
             console.log(`id 为 ${layerId} 的 invert 图层不需要额外参数`);
+        } else if (layer_operation === 'equalize') {
+            // 添加均衡化方式的更新逻辑
+            const layerElement = document.querySelector(`[data-layer-id="${layerId}"]`);
+            if (layerElement) {
+                const modeSelect = layerElement.querySelector('.equalize-mode-select');
+                if (modeSelect) {
+                    layer.params = {
+                        mode: modeSelect.value
+                    };
+                    console.log(`id 为 ${layerId} 的 equalize 图层方式为 ${layer.params.mode}`)
+                } else {
+                    console.error(`未找到 id 为 ${layerId} 的 equalize 方式选择器`);
+                }
+            } else {
+                console.error(`未找到 id 为 ${layerId} 的图层元素`);
+            }
+        } else if (layer_operation === 'lut3d') {
+            // .cube 文件内容在选择文件时已经写入图层参数
+            if (!layer.params.cube) {
+                console.error(`id 为 ${layerId} 的 lut3d 图层尚未选择 .cube 文件`);
+            }
+        } else if (layer_operation === 'binarize') {
+            // 二值化参数在控件变化时已经写入图层参数
+            console.log(`id 为 ${layerId} 的 binarize 图层参数为 ${JSON.stringify(layer.params)}`);
+        } else if (layer_operation === 'convolve') {
+            // 卷积核在文本框变化时已经解析并写入图层参数
+            if (!layer.params.kernel) {
+                console.error(`id 为 ${layerId} 的 convolve 图层卷积核无效`);
+            }
+        } else if (numberLayerFields[layer_operation]) {
+            // 数值参数在输入框变化时已经写入图层参数
+            console.log(`id 为 ${layerId} 的 ${layer_operation} 图层参数为 ${JSON.stringify(layer.params)}`);
+        } else if (layer_operation === 'autolevels' || layer_operation === 'autowb') {
+            // 自动图层的参数由统计结果决定，保持创建时的默认值
+            console.log(`id 为 ${layerId} 的 ${layer_operation} 图层不需要额外参数`);
         }
     } // function updateLayerParams END
 
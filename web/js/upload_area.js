@@ -44,9 +44,9 @@ export function initUploadAreaEvents() {
     function handleFileSelect(file) {
         console.log('处理文件选择', file);
         // 检查文件类型
-        const validTypes = ['image/jpeg', 'image/png', 'image/ppm'];
+        const validTypes = ['image/jpeg', 'image/png', 'image/webp', 'image/ppm'];
         if (!validTypes.includes(file.type) && !file.name.toLowerCase().endsWith('.ppm')) {
-            alert('请选择有效的图像文件 (JPG, PNG, PPM)');
+            alert('请选择有效的图像文件 (JPG, PNG, WebP, PPM)');
             return;
         }
         